@@ -0,0 +1,110 @@
+#include "AnimatedBoundsBuilder.h"
+#include "BoundsBuilder.h"
+#include "PoseEvaluator.h"
+
+#include <algorithm>
+#include <cmath>
+
+void AnimatedBoundsBuilder::BuildAnimatedBounds(CompiledModel& Mesh, size_t Segments, float SampleRate)
+{
+	auto& animations{ Mesh.GetAnimations() };
+	auto& bone_info_map{ Mesh.GetBoneInfoMap() };
+
+	if (animations.empty())
+		return;
+
+	BoneGeometry geometry{ ComputeBoneGeometry(Mesh) };
+
+	std::vector<CompiledModel::AnimatedBounds> results(animations.size());
+
+	PoseEvaluator::ForEachClip(Mesh,
+							   [&](const std::string&, Animation& Clip, size_t Index)
+							   {
+								   results[Index] = ComputeClipBounds(Clip, geometry, bone_info_map, (std::max)(Segments, size_t{ 1 }), SampleRate);
+							   });
+
+	size_t i{ 0 };
+
+	for (auto& [name, animation] : animations)
+		Mesh.GetAnimatedBounds()[name] = std::move(results[i++]);
+}
+
+AnimatedBoundsBuilder::BoneGeometry AnimatedBoundsBuilder::ComputeBoneGeometry(CompiledModel& Mesh)
+{
+	auto& bone_info_map{ Mesh.GetBoneInfoMap() };
+	BoneGeometry geometry{ BoundsBuilder::ComputeSkinnedBounds(Mesh, true), {}, BoundsBuilder::Empty() };
+
+	for (auto& sub_mesh : Mesh.GetSubMeshes())
+	{
+		if (sub_mesh.m_Attributes & CompiledModel::Attribute_Skin)
+			continue;
+
+		for (const auto& instance : sub_mesh.m_Instances)
+		{
+			auto bone{ bone_info_map.find(instance.m_AnimatedNode) };
+
+			if (instance.m_AnimatedNode.empty() || bone == bone_info_map.end())
+				geometry.m_Static = BoundsBuilder::Merge(geometry.m_Static, BoundsBuilder::Transform(sub_mesh.m_Bounds, instance.m_Transform));
+			else
+				geometry.m_Attached.push_back({ BoundsBuilder::Transform(sub_mesh.m_Bounds, instance.m_NodeTransform), bone->second.id });
+		}
+	}
+
+	return geometry;
+}
+
+CompiledModel::AnimatedBounds AnimatedBoundsBuilder::ComputeClipBounds(Animation& Clip, const BoneGeometry& Geometry, std::unordered_map<std::string, BoneInfo>& BoneInfoMap, size_t Segments, float SampleRate)
+{
+	std::vector<Bone> bones{ Clip.GetBones() };
+	PoseEvaluator::TrackMap tracks{ PoseEvaluator::GetTracks(bones) };
+
+	float ticks_per_second{ PoseEvaluator::GetTicksPerSecond(Clip) };
+	float duration{ (std::max)(Clip.GetDuration(), 0.0f) };
+
+	//options reject non positive rates, other callers still get a finite sample count (NaN included)
+	if (!(SampleRate > 0.0f))
+		SampleRate = 1.0f;
+
+	size_t samples_per_segment{ static_cast<size_t>(std::ceil(duration / ticks_per_second * SampleRate / Segments)) + 1 };
+
+	CompiledModel::AnimatedBounds result{ BoundsBuilder::Empty(),
+										  std::vector<CompiledModel::Bounds>(Segments, BoundsBuilder::Empty()),
+										  std::vector<CompiledModel::Bounds>(Geometry.m_Skinned.size(), BoundsBuilder::Empty()) };
+
+	std::vector<glm::mat4> global_transforms(Geometry.m_Skinned.size(), glm::mat4{ 1.0f });
+
+	for (size_t segment = 0; segment < Segments; ++segment)
+	{
+		CompiledModel::Bounds& segment_bounds{ result.m_Segments[segment] };
+		segment_bounds = Geometry.m_Static;
+
+		//segment ends are sampled by both neighbouring segments
+		for (size_t sample = 0; sample < samples_per_segment; ++sample)
+		{
+			float time{ duration * (segment + static_cast<float>(sample) / (std::max)(samples_per_segment - 1, size_t{ 1 })) / Segments };
+
+			PoseEvaluator::ComputeGlobalTransforms(Clip.GetRootNode(), glm::mat4{ 1.0f }, time, tracks, BoneInfoMap, global_transforms);
+
+			for (size_t bone_id = 0; bone_id < Geometry.m_Skinned.size(); ++bone_id)
+			{
+				if (Geometry.m_Skinned[bone_id].m_Radius < 0.0f)
+					continue;
+
+				auto bounds{ BoundsBuilder::Transform(Geometry.m_Skinned[bone_id], global_transforms[bone_id]) };
+				result.m_Bones[bone_id] = BoundsBuilder::Merge(result.m_Bones[bone_id], bounds);
+				segment_bounds = BoundsBuilder::Merge(segment_bounds, bounds);
+			}
+
+			for (const auto& [attached_bounds, bone_id] : Geometry.m_Attached)
+			{
+				auto bounds{ BoundsBuilder::Transform(attached_bounds, global_transforms[bone_id]) };
+				result.m_Bones[bone_id] = BoundsBuilder::Merge(result.m_Bones[bone_id], bounds);
+				segment_bounds = BoundsBuilder::Merge(segment_bounds, bounds);
+			}
+		}
+
+		result.m_Bounds = BoundsBuilder::Merge(result.m_Bounds, segment_bounds);
+	}
+
+	return result;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "CompiledModel.h"
+
+//Samples every animation clip and bounds the skinned and node attached geometry over time,
+//so the engine can cull animated instances without skinning on the CPU.
+class AnimatedBoundsBuilder
+{
+public:
+	//Segments splits each clip into equal time ranges with their own bounds, SampleRate is in samples per second
+	static void BuildAnimatedBounds(CompiledModel& Mesh, size_t Segments, float SampleRate);
+
+private:
+	//Geometry each bone moves, in the bone's space (offset applied) for skinning and in node space for node attached parts
+	struct BoneGeometry
+	{
+		std::vector<CompiledModel::Bounds> m_Skinned;
+		std::vector<std::pair<CompiledModel::Bounds, int>> m_Attached;		//bounds in attached node space, bone id
+		CompiledModel::Bounds m_Static;
+	};
+
+	static BoneGeometry ComputeBoneGeometry(CompiledModel& Mesh);
+	static CompiledModel::AnimatedBounds ComputeClipBounds(Animation& Clip, const BoneGeometry& Geometry, std::unordered_map<std::string, BoneInfo>& BoneInfoMap, size_t Segments, float SampleRate);
+};
@@ -5,7 +5,12 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <algorithm>
 #include "Bone.h"
+#include "SoaClip.h"
+#include "SkeletonTable.h"
+#include "KeyTimelines.h"
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
@@ -28,6 +33,9 @@ class Animation
     float m_Duration;
     float m_TicksPerSecond;
     std::vector<Bone> m_Bones;
+    SoaClip m_SoaTracks;        //every bone's keys when the bones are TrackEncoding::Soa
+    SkeletonTable m_Skeleton;   //m_RootNode flattened and bound to m_Bones
+    KeyTimelines m_Timelines;   //timestamps of the bones that are TrackEncoding::Timelines
     NodeData m_RootNode;
     std::unordered_map < std::string, BoneInfo > m_BoneInfoMap;
 
@@ -56,9 +64,11 @@ class Animation
             auto channel {animation->mChannels[i]};
             std::string bone_name{ channel->mNodeName.data };
 
+            //animated nodes without skin get an identity offset, so their final bone matrix is the node's own transform
             if (bone_info_map.find(bone_name) == bone_info_map.end())
             {
-                bone_info_map[bone_name].id = static_cast<int>(bone_info_map.size());
+                int id{ static_cast<int>(bone_info_map.size()) };
+                bone_info_map[bone_name] = { id, glm::mat4{ 1.0f } };
             }
 
             m_Bones.push_back({CreateBone(bone_name,
@@ -145,12 +155,46 @@ public:
 
     float& GetDuration() { return m_Duration; }
 
-    std::vector<Bone> GetBones() { return m_Bones; }
+    std::vector<Bone>& GetBones() { return m_Bones; }
+
+    void SetBones(std::vector<Bone> bones) { m_Bones = std::move(bones); }
+
+    SoaClip& GetSoaTracks() { return m_SoaTracks; }
+
+    void SetSoaTracks(SoaClip soa_tracks) { m_SoaTracks = std::move(soa_tracks); }
+
+    SkeletonTable& GetSkeleton() { return m_Skeleton; }
+
+    void SetSkeleton(SkeletonTable skeleton) { m_Skeleton = std::move(skeleton); }
+
+    KeyTimelines& GetTimelines() { return m_Timelines; }
+
+    void SetTimelines(KeyTimelines timelines) { m_Timelines = std::move(timelines); }
 
     NodeData& GetRootNode() { return m_RootNode; }
 
     const std::unordered_map<std::string, BoneInfo>& GetBoneIDMap() { return m_BoneInfoMap; }
 
+    //renumbers bones to remap[old id] and keeps m_Bones ordered by the new ids
+    void RemapBoneIDs(const std::vector<int>& remap)
+    {
+        for (auto& [name, bone_info] : m_BoneInfoMap)
+        {
+            bone_info.id = remap[bone_info.id];
+        }
+
+        for (auto& bone : m_Bones)
+        {
+            bone.m_ID = remap[bone.m_ID];
+        }
+
+        std::stable_sort(m_Bones.begin(), m_Bones.end(),
+                         [](const Bone& lhs, const Bone& rhs)
+                         {
+                             return lhs.m_ID < rhs.m_ID;
+                         });
+    }
+
 
 
 };
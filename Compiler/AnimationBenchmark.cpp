@@ -0,0 +1,141 @@
+#include "AnimationBenchmark.h"
+#include "AnimationSampler.h"
+#include "PoseEvaluator.h"
+
+#include <chrono>
+#include <random>
+#include <cmath>
+
+namespace
+{
+	constexpr size_t s_Updates{ 2048 };
+	constexpr float s_UpdateRate{ 60.0f };
+}
+
+std::vector<AnimationBenchmark::ClipReport> AnimationBenchmark::MeasureClips(CompiledModel& Mesh)
+{
+	std::vector<ClipReport> reports;
+
+	//one clip at a time, parallel runs would disturb each other's timings
+	for (auto& [name, animation] : Mesh.GetAnimations())
+	{
+		ClipReport& report{ reports.emplace_back(ClipReport{ name, animation.GetBones().size(), 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 }) };
+
+		//soa and timeline bones need their clip, Bone::Update runs on their float keys instead
+		std::vector<Bone> bones{ animation.GetBones() };
+
+		for (auto& bone : bones)
+		{
+			if (bone.m_Encoding == TrackEncoding::Soa || bone.m_Encoding == TrackEncoding::Timelines)
+				bone.m_Encoding = TrackEncoding::Keys;
+		}
+
+		auto update_bones = [&](float Time)
+		{
+			float sum{};
+
+			for (auto& bone : bones)
+			{
+				bone.Update(Time);
+				sum += bone.m_LocalTransform[3][0];
+			}
+
+			return sum;
+		};
+
+		AnimationSampler sampler{ animation };
+
+		auto update_sampler = [&](float Time)
+		{
+			float sum{};
+			sampler.Update(Time);
+
+			for (const auto& transform : sampler.GetLocalTransforms())
+				sum += transform[3][0];
+
+			return sum;
+		};
+
+		std::vector<float> forward{ GetForwardTimes(animation) };
+		std::vector<float> seeks{ GetSeekTimes(animation) };
+
+		report.m_BoneForward = MeasureUpdates(forward, bones.size(), update_bones);
+		report.m_SamplerForward = MeasureUpdates(forward, bones.size(), update_sampler);
+
+		sampler.Reset();
+		report.m_BoneSeek = MeasureUpdates(seeks, bones.size(), update_bones);
+		report.m_SamplerSeek = MeasureUpdates(seeks, bones.size(), update_sampler);
+
+		//local pose of the float keys before and after direct composition, sampling itself is the same
+		std::vector<Bone> slerp_bones{ animation.GetBones() };
+
+		for (auto& bone : slerp_bones)
+		{
+			bone.m_Encoding = TrackEncoding::Keys;
+			bone.m_Nlerp = false;
+		}
+
+		for (auto& bone : bones)
+			bone.m_Encoding = TrackEncoding::Keys;
+
+		report.m_ComposeBefore = MeasureUpdates(forward, bones.size(),
+												[&](float Time)
+												{
+													float sum{};
+
+													for (auto& bone : slerp_bones)
+													{
+														bone.m_LocalTransform = bone.InterpolatePosition(Time) * bone.InterpolateRotation(Time) * bone.InterpolateScaling(Time);
+														sum += bone.m_LocalTransform[3][0];
+													}
+
+													return sum;
+												});
+		report.m_ComposeAfter = MeasureUpdates(forward, bones.size(), update_bones);
+	}
+
+	return reports;
+}
+
+std::vector<float> AnimationBenchmark::GetForwardTimes(Animation& Clip)
+{
+	float duration{ (std::max)(Clip.GetDuration(), 0.0f) };
+	float step{ PoseEvaluator::GetTicksPerSecond(Clip) / s_UpdateRate };
+	std::vector<float> times(s_Updates);
+
+	for (size_t i = 0; i < s_Updates; ++i)
+		times[i] = duration > 0.0f ? std::fmod(static_cast<float>(i) * step, duration) : 0.0f;
+
+	return times;
+}
+
+std::vector<float> AnimationBenchmark::GetSeekTimes(Animation& Clip)
+{
+	//fixed seed so runs stay comparable
+	std::minstd_rand generator{ 1 };
+	std::uniform_real_distribution<float> distribution{ 0.0f, (std::max)(Clip.GetDuration(), 0.0f) };
+	std::vector<float> times(s_Updates);
+
+	for (auto& time : times)
+		time = distribution(generator);
+
+	return times;
+}
+
+template <typename Update>
+double AnimationBenchmark::MeasureUpdates(const std::vector<float>& Times, size_t Bones, Update UpdateAt)
+{
+	if (Times.empty() || !Bones)
+		return 0.0;
+
+	//untimed pass to warm caches
+	volatile float sink{ UpdateAt(Times.front()) };
+	auto start{ std::chrono::steady_clock::now() };
+
+	for (float time : Times)
+		sink = sink + UpdateAt(time);
+
+	std::chrono::duration<double, std::nano> elapsed{ std::chrono::steady_clock::now() - start };
+
+	return elapsed.count() / static_cast<double>(Times.size() * Bones);
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "CompiledModel.h"
+
+//Times the runtime sampling paths on a model's clips, for comparing them on real assets.
+//Nothing is written to the compiled file.
+class AnimationBenchmark
+{
+public:
+	//Nanoseconds per bone and update
+	struct ClipReport
+	{
+		std::string m_Name;
+		size_t m_Bones;
+		double m_BoneForward;		//Bone::Update, playing at 60 updates per second and looping
+		double m_SamplerForward;	//AnimationSampler::Update, same times
+		double m_BoneSeek;			//Bone::Update at random times
+		double m_SamplerSeek;		//AnimationSampler::Update, same times
+		double m_ComposeBefore;		//float keys, slerp and translate * toMat4 * scale, forward times
+		double m_ComposeAfter;		//float keys, nlerp where flagged and Bone::ComposeTransform, forward times
+	};
+
+	static std::vector<ClipReport> MeasureClips(CompiledModel& Mesh);
+
+private:
+	static std::vector<float> GetForwardTimes(Animation& Clip);
+	static std::vector<float> GetSeekTimes(Animation& Clip);
+
+	//times Update(time) over Times, Update returns a value summed so it cannot be optimised away
+	template <typename Update>
+	static double MeasureUpdates(const std::vector<float>& Times, size_t Bones, Update UpdateAt);
+};
@@ -0,0 +1,153 @@
+#pragma once
+#include "Animation.h"
+#include "KeySearch.h"
+#include <vector>
+#include <algorithm>
+
+//Playback state of one clip. Every channel remembers the key it used last, so forward playback
+//only steps over the keys it passed. Seeks and loops fall back to binary search, and times outside
+//the clip clamp to the first / last key. Channels on the clip's shared timelines keep one cursor per timeline.
+class AnimationSampler
+{
+    struct Cursor
+    {
+        size_t m_Position{};
+        size_t m_Rotation{};
+        size_t m_Scale{};
+    };
+
+    const std::vector<Bone>* m_Bones{ nullptr };
+    const SoaClip* m_SoaTracks{ nullptr };
+    const KeyTimelines* m_Timelines{ nullptr };
+    std::vector<Cursor> m_Cursors;
+    std::vector<std::uint32_t> m_TimelineCursors;
+    std::vector<TimelineFrame> m_TimelineFrames;
+    std::vector<glm::mat4> m_LocalTransforms;
+
+public:
+    AnimationSampler() = default;
+
+    //the clip must outlive the sampler
+    explicit AnimationSampler(Animation& animation)
+        : m_Bones{ &animation.GetBones() },
+          m_SoaTracks{ animation.GetSoaTracks().Empty() ? nullptr : &animation.GetSoaTracks() },
+          m_Timelines{ animation.GetTimelines().Empty() ? nullptr : &animation.GetTimelines() },
+          m_Cursors(m_Bones->size()),
+          m_LocalTransforms(m_Bones->size(), glm::mat4{ 1.0f })
+    {
+
+    }
+
+    void Reset()
+    {
+        std::fill(m_Cursors.begin(), m_Cursors.end(), Cursor{});
+        std::fill(m_TimelineCursors.begin(), m_TimelineCursors.end(), 0);
+    }
+
+    //samples every bone at current_time, in ticks
+    void Update(float current_time)
+    {
+        //soa clips evaluate every bone in one pass, uniform rates need no cursors
+        if (m_SoaTracks)
+        {
+            m_SoaTracks->Evaluate(current_time, m_LocalTransforms);
+            return;
+        }
+
+        //shared timelines are searched once, their bones only index and interpolate
+        if (m_Timelines)
+        {
+            m_Timelines->Evaluate(current_time, m_TimelineCursors, m_TimelineFrames);
+        }
+
+        for (size_t i = 0; i < m_Cursors.size(); ++i)
+        {
+            m_LocalTransforms[i] = SampleBone((*m_Bones)[i], m_Cursors[i], m_TimelineFrames, current_time);
+        }
+    }
+
+    //in the order of Animation::GetBones()
+    const glm::mat4& GetLocalTransform(size_t bone) const { return m_LocalTransforms[bone]; }
+
+    const std::vector<glm::mat4>& GetLocalTransforms() const { return m_LocalTransforms; }
+
+private:
+    static glm::mat4 SampleBone(const Bone& bone, Cursor& cursor, const std::vector<TimelineFrame>& timeline_frames, float time)
+    {
+        //channels without keys keep the bind pose
+        glm::vec3 position{ bone.m_BindPosition };
+        glm::quat rotation{ bone.m_BindRotation };
+        glm::vec3 scale{ bone.m_BindScale };
+
+        if (bone.m_Encoding == TrackEncoding::Keys)
+        {
+            SampleKeys(bone.m_Positions, cursor.m_Position, time, position,
+                       [](const KeyPosition& key) { return key.m_Position; },
+                       [](const glm::vec3& a, const glm::vec3& b, float t) { return glm::mix(a, b, t); });
+
+            SampleKeys(bone.m_Rotations, cursor.m_Rotation, time, rotation,
+                       [](const KeyRotation& key) { return key.m_Orientation; },
+                       [&](const glm::quat& a, const glm::quat& b, float t) { return Orientation::Interpolate(a, b, t, bone.m_Nlerp); });
+
+            SampleKeys(bone.m_Scales, cursor.m_Scale, time, scale,
+                       [](const KeyScale& key) { return key.m_Scale; },
+                       [](const glm::vec3& a, const glm::vec3& b, float t) { return glm::mix(a, b, t); });
+        }
+
+        else if (bone.m_Encoding == TrackEncoding::Quantized)
+        {
+            const QuantizedTrack& track{ bone.m_Quantized };
+            float frame{ time / track.m_FrameDuration };
+
+            SampleKeys(track.m_Positions, cursor.m_Position, frame, position,
+                       [&](const QuantizedKey& key) { return QuantizedTrack::DecodeVector(key, track.m_PositionMin, track.m_PositionExtent); },
+                       [](const glm::vec3& a, const glm::vec3& b, float t) { return glm::mix(a, b, t); });
+
+            SampleKeys(track.m_Rotations, cursor.m_Rotation, frame, rotation,
+                       [](const QuantizedKey& key) { return QuantizedTrack::DecodeRotation(key); },
+                       [](const glm::quat& a, const glm::quat& b, float t) { return Orientation::Interpolate(a, b, t, false); });
+
+            SampleKeys(track.m_Scales, cursor.m_Scale, frame, scale,
+                       [&](const QuantizedKey& key) { return QuantizedTrack::DecodeVector(key, track.m_ScaleMin, track.m_ScaleExtent); },
+                       [](const glm::vec3& a, const glm::vec3& b, float t) { return glm::mix(a, b, t); });
+        }
+
+        else if (bone.m_Encoding == TrackEncoding::Timelines)
+        {
+            bone.m_Timeline.Sample(timeline_frames, position, rotation, scale, bone.m_Nlerp);
+        }
+
+        //curve knots are sparse, their binary search is cheap
+        else if (bone.m_Encoding == TrackEncoding::Curves)
+        {
+            bone.m_Curves.Sample(time, position, rotation, scale);
+        }
+
+        //uniform tracks index keys by time, there is nothing to search
+        else
+        {
+            bone.m_Uniform.Sample(time, position, rotation, scale, bone.m_Nlerp);
+        }
+
+        return Bone::ComposeTransform(position, rotation, scale);
+    }
+
+    template <typename Key, typename Value, typename Decode, typename Interpolate>
+    static void SampleKeys(const std::vector<Key>& keys, size_t& cursor, float time, Value& value, Decode decode, Interpolate interpolate)
+    {
+        if (keys.empty())
+            return;
+
+        auto time_at = [&](size_t index) { return GetTimeStamp(keys[index]); };
+
+        cursor = KeySearch::Seek(keys.size(), cursor, time, time_at);
+        size_t next{ (std::min)(cursor + 1, keys.size() - 1) };
+
+        value = interpolate(decode(keys[cursor]), decode(keys[next]), KeySearch::Factor(cursor, next, time, time_at));
+    }
+
+    static float GetTimeStamp(const KeyPosition& key) { return key.m_TimeStamp; }
+    static float GetTimeStamp(const KeyRotation& key) { return key.m_TimeStamp; }
+    static float GetTimeStamp(const KeyScale& key) { return key.m_TimeStamp; }
+    static float GetTimeStamp(const QuantizedKey& key) { return static_cast<float>(key.m_Frame); }
+};
@@ -4,6 +4,12 @@
 #include "glm/gtx/quaternion.hpp"
 #include <vector>
 #include <string>
+#include "KeySearch.h"
+#include "Orientation.h"
+#include "QuantizedTrack.h"
+#include "UniformTrack.h"
+#include "CurveTrack.h"
+#include "KeyTimelines.h"
 
 struct KeyPosition
 {
@@ -23,12 +29,36 @@ struct KeyScale
     float m_TimeStamp;
 };
 
+//How a bone's keys are stored. In the compiler the float keys stay next to every other encoding
+//for later compile steps, only the file gets the selected one
+enum class TrackEncoding : std::uint8_t
+{
+    Keys,           //float keys with timestamps
+    Quantized,      //m_Quantized, 8 bytes per key
+    Uniform,        //m_Uniform, resampled at a fixed rate without timestamps
+    Soa,            //no keys, they live in the clip's SoaClip and are sampled with SoaClip::Evaluate
+    Curves,         //m_Curves, cubic Hermite knots
+    Timelines       //m_Timeline, key values on the clip's KeyTimelines, sampled with AnimationSampler
+};
+
 struct Bone
 {
     std::vector<KeyPosition> m_Positions;
     std::vector<KeyRotation> m_Rotations;
     std::vector<KeyScale> m_Scales;
 
+    TrackEncoding m_Encoding{ TrackEncoding::Keys };
+    QuantizedTrack m_Quantized;
+    UniformTrack m_Uniform;
+    CurveTrack m_Curves;
+    TimelineTrack m_Timeline;
+    bool m_Nlerp{ false };              //rotation keys share a hemisphere and nlerp stays within the compiler's tolerance of slerp
+
+    //node's bind pose, used for every channel without keys
+    glm::vec3 m_BindPosition{ 0.0f };
+    glm::quat m_BindRotation{ 1.0f, 0.0f, 0.0f, 0.0f };
+    glm::vec3 m_BindScale{ 1.0f };
+
     glm::mat4 m_LocalTransform;
     std::string m_Name;
     int m_ID;
@@ -45,71 +75,93 @@ struct Bone
 
     }
 
-    float GetScaleFactor(float lastTimeStamp, float nextTimeStamp, float animationTime)
+    glm::vec3 SamplePosition(float animationTime)
     {
-        float scaleFactor = 0.0f;
-        float midWayLength = animationTime - lastTimeStamp;
-        float framesDiff = nextTimeStamp - lastTimeStamp;
-        scaleFactor = midWayLength / framesDiff;
-        return scaleFactor;
-    }
+        if (m_Positions.empty())
+        {
+            return m_BindPosition;
+        }
 
-    glm::mat4 InterpolatePosition(float animationTime)
-    {
         if (m_Positions.size() == 1)
         {
-            return glm::translate( glm::mat4(1.0f), m_Positions[0].m_Position );
+            return m_Positions[0].m_Position;
         }
 
         int p0Index = GetPositionIndex(animationTime);
         int p1Index = p0Index + 1;
 
-        float scaleFactor = GetScaleFactor(m_Positions[p0Index].m_TimeStamp,
-                                           m_Positions[p1Index].m_TimeStamp, animationTime);
+        float scaleFactor = KeySearch::Factor(p0Index, p1Index, animationTime,
+                                              [&](size_t index) { return m_Positions[index].m_TimeStamp; });
 
-        glm::vec3 finalPosition = glm::mix(m_Positions[p0Index].m_Position,
-                                           m_Positions[p1Index].m_Position, scaleFactor);
-
-        return glm::translate(glm::mat4(1.0f), finalPosition);
+        return glm::mix(m_Positions[p0Index].m_Position, m_Positions[p1Index].m_Position, scaleFactor);
     }
 
-    glm::mat4 InterpolateRotation(float animationTime)
+    glm::quat SampleRotation(float animationTime)
     {
+        if (m_Rotations.empty())
+        {
+            return m_BindRotation;
+        }
+
         if (m_Rotations.size() == 1)
         {
-            auto rotation = glm::normalize(m_Rotations[0].m_Orientation);
-            return glm::toMat4(rotation);
+            return glm::normalize(m_Rotations[0].m_Orientation);
         }
 
         int p0Index = GetRotationIndex(animationTime);
         int p1Index = p0Index + 1;
 
-        float scaleFactor = GetScaleFactor(m_Rotations[p0Index].m_TimeStamp,
-                                           m_Rotations[p1Index].m_TimeStamp, animationTime);
-
-        glm::quat finalRotation = glm::slerp(m_Rotations[p0Index].m_Orientation,
-                                             m_Rotations[p1Index].m_Orientation, scaleFactor);
+        float scaleFactor = KeySearch::Factor(p0Index, p1Index, animationTime,
+                                              [&](size_t index) { return m_Rotations[index].m_TimeStamp; });
 
-        return glm::toMat4(glm::normalize(finalRotation));
+        return Orientation::Interpolate(m_Rotations[p0Index].m_Orientation, m_Rotations[p1Index].m_Orientation, scaleFactor, m_Nlerp);
     }
 
-    glm::mat4 InterpolateScaling(float animationTime)
+    glm::vec3 SampleScaling(float animationTime)
     {
+        if (m_Scales.empty())
+        {
+            return m_BindScale;
+        }
+
         if (m_Scales.size() == 1)
         {
-            return glm::scale(glm::mat4(1.0f), m_Scales[0].m_Scale);
+            return m_Scales[0].m_Scale;
         }
 
         int p0Index = GetScaleIndex(animationTime);
         int p1Index = p0Index + 1;
 
-        float scaleFactor = GetScaleFactor(m_Scales[p0Index].m_TimeStamp,
-                                           m_Scales[p1Index].m_TimeStamp, animationTime);
+        float scaleFactor = KeySearch::Factor(p0Index, p1Index, animationTime,
+                                              [&](size_t index) { return m_Scales[index].m_TimeStamp; });
+
+        return glm::mix(m_Scales[p0Index].m_Scale, m_Scales[p1Index].m_Scale, scaleFactor);
+    }
+
+    glm::mat4 InterpolatePosition(float animationTime)
+    {
+        return glm::translate(glm::mat4(1.0f), SamplePosition(animationTime));
+    }
 
-        glm::vec3 finalScale = glm::mix(m_Scales[p0Index].m_Scale, m_Scales[p1Index].m_Scale,
-                                        scaleFactor);
+    glm::mat4 InterpolateRotation(float animationTime)
+    {
+        return glm::toMat4(SampleRotation(animationTime));
+    }
 
-        return glm::scale(glm::mat4(1.0f), finalScale);
+    glm::mat4 InterpolateScaling(float animationTime)
+    {
+        return glm::scale(glm::mat4(1.0f), SampleScaling(animationTime));
+    }
+
+    //translate * rotate * scale without building and multiplying three matrices
+    static glm::mat4 ComposeTransform(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        glm::mat3 basis{ glm::mat3_cast(rotation) };
+
+        return { glm::vec4{ basis[0] * scale.x, 0.0f },
+                 glm::vec4{ basis[1] * scale.y, 0.0f },
+                 glm::vec4{ basis[2] * scale.z, 0.0f },
+                 glm::vec4{ position, 1.0f } };
     }
 
     Bone(std::vector<KeyPosition> positions, std::vector<KeyRotation> rotations,
@@ -120,17 +172,68 @@ struct Bone
 
     }
 
+    Bone(QuantizedTrack quantized, glm::mat4 local_transform, std::string name, int id)
+        : m_Encoding{ TrackEncoding::Quantized }, m_Quantized{ std::move(quantized) },
+            m_LocalTransform{ local_transform }, m_Name{ name }, m_ID{ id }
+    {
+
+    }
+
+    Bone(UniformTrack uniform, glm::mat4 local_transform, std::string name, int id)
+        : m_Encoding{ TrackEncoding::Uniform }, m_Uniform{ std::move(uniform) },
+            m_LocalTransform{ local_transform }, m_Name{ name }, m_ID{ id }
+    {
+
+    }
+
+    Bone(CurveTrack curves, glm::mat4 local_transform, std::string name, int id)
+        : m_Encoding{ TrackEncoding::Curves }, m_Curves{ std::move(curves) },
+            m_LocalTransform{ local_transform }, m_Name{ name }, m_ID{ id }
+    {
+
+    }
+
     void Update(float current_time)
     {
-        glm::mat4 translation{ InterpolatePosition(current_time) };
-        glm::mat4 rotation{ InterpolateRotation(current_time) };
-        glm::mat4 scale{ InterpolateScaling(current_time) };
-        m_LocalTransform = translation * rotation * scale;
+        //both need the clip, AnimationSampler evaluates them
+        if (m_Encoding == TrackEncoding::Soa || m_Encoding == TrackEncoding::Timelines)
+        {
+            return;
+        }
+
+        //encoded tracks leave channels without keys untouched
+        glm::vec3 position{ m_BindPosition };
+        glm::quat rotation{ m_BindRotation };
+        glm::vec3 scale{ m_BindScale };
+
+        if (m_Encoding == TrackEncoding::Quantized)
+        {
+            m_Quantized.Sample(current_time, position, rotation, scale);
+        }
+
+        else if (m_Encoding == TrackEncoding::Uniform)
+        {
+            m_Uniform.Sample(current_time, position, rotation, scale, m_Nlerp);
+        }
+
+        else if (m_Encoding == TrackEncoding::Curves)
+        {
+            m_Curves.Sample(current_time, position, rotation, scale);
+        }
+
+        else
+        {
+            position = SamplePosition(current_time);
+            rotation = SampleRotation(current_time);
+            scale = SampleScaling(current_time);
+        }
+
+        m_LocalTransform = ComposeTransform(position, rotation, scale);
     }
 
     int GetPositionIndex(float animationTime)
     {
-        for (int index = 0; index < m_Positions.size() - 1; ++index)
+        for (int index = 0; index < static_cast<int>(m_Positions.size()) - 1; ++index)
         {
             if (animationTime < m_Positions[index + 1].m_TimeStamp)
             {
@@ -138,12 +241,13 @@ struct Bone
             }
         }
 
-        return -1;
+        //past the last key, interpolate the last pair to its end
+        return static_cast<int>(m_Positions.size()) - 2;
     }
 
     int GetRotationIndex(float animationTime)
     {
-        for (int index = 0; index < m_Rotations.size() - 1; ++index)
+        for (int index = 0; index < static_cast<int>(m_Rotations.size()) - 1; ++index)
         {
             if (animationTime < m_Rotations[index + 1].m_TimeStamp)
             {
@@ -151,12 +255,13 @@ struct Bone
             }
         }
 
-        return -1;
+        //past the last key, interpolate the last pair to its end
+        return static_cast<int>(m_Rotations.size()) - 2;
     }
 
     int GetScaleIndex(float animationTime)
     {
-        for (int index = 0; index < m_Scales.size() - 1; ++index)
+        for (int index = 0; index < static_cast<int>(m_Scales.size()) - 1; ++index)
         {
             if (animationTime < m_Scales[index + 1].m_TimeStamp)
             {
@@ -164,7 +269,8 @@ struct Bone
             }
         }
 
-        return -1;
+        //past the last key, interpolate the last pair to its end
+        return static_cast<int>(m_Scales.size()) - 2;
     }
 
     glm::mat4 GetLocalTransform() { return m_LocalTransform; }
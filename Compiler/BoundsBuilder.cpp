@@ -0,0 +1,213 @@
+#include "BoundsBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define BOUNDS_SSE
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	glm::vec3 LoadPosition(const std::uint8_t* position)
+	{
+		glm::vec3 result;
+		std::memcpy(&result, position, sizeof(glm::vec3));
+		return result;
+	}
+}
+
+CompiledModel::Bounds BoundsBuilder::Transform(const CompiledModel::Bounds& Bounds, const glm::mat4& Transform)
+{
+	if (Bounds.m_Radius < 0.0f)
+		return Bounds;
+
+	glm::vec3 translation{ Transform[3] };
+	CompiledModel::Bounds bounds{ translation, translation, glm::vec3{ Transform * glm::vec4{ Bounds.m_Center, 1.0f } }, 0.0f };
+
+	//each output axis takes the smaller / larger contribution of every input axis
+	for (int column = 0; column < 3; ++column)
+	{
+		glm::vec3 a{ glm::vec3{ Transform[column] } * Bounds.m_Min[column] };
+		glm::vec3 b{ glm::vec3{ Transform[column] } * Bounds.m_Max[column] };
+
+		bounds.m_Min += glm::min(a, b);
+		bounds.m_Max += glm::max(a, b);
+	}
+
+	float scale{ (std::max)({ glm::length(glm::vec3{ Transform[0] }),
+							  glm::length(glm::vec3{ Transform[1] }),
+							  glm::length(glm::vec3{ Transform[2] }) }) };
+
+	bounds.m_Radius = Bounds.m_Radius * scale;
+
+	return bounds;
+}
+
+CompiledModel::Bounds BoundsBuilder::Empty()
+{
+	return { glm::vec3{ std::numeric_limits<float>::max() }, glm::vec3{ std::numeric_limits<float>::lowest() }, glm::vec3{ 0.0f }, -1.0f };
+}
+
+std::vector<CompiledModel::Bounds> BoundsBuilder::ComputeSkinnedBounds(CompiledModel& Mesh, bool BoneSpace)
+{
+	std::vector<const BoneInfo*> bone_infos;
+
+	for (const auto& [name, bone_info] : Mesh.GetBoneInfoMap())
+	{
+		if (bone_info.id >= static_cast<int>(bone_infos.size()))
+			bone_infos.resize(bone_info.id + 1, nullptr);
+
+		bone_infos[bone_info.id] = &bone_info;
+	}
+
+	std::vector<glm::vec3> mins(bone_infos.size(), glm::vec3{ std::numeric_limits<float>::max() });
+	std::vector<glm::vec3> maxs(bone_infos.size(), glm::vec3{ std::numeric_limits<float>::lowest() });
+
+	for (const auto& sub_mesh : Mesh.GetSubMeshes())
+	{
+		if (!(sub_mesh.m_Attributes & CompiledModel::Attribute_Skin))
+			continue;
+
+		//every skinned vertex stays inside the boxes of the bones influencing it
+		for (const auto& vertex : sub_mesh.m_Vertices)
+		{
+			for (int i = 0; i < 4; ++i)
+			{
+				if (vertex.m_BoneIDs[i] == -1 || vertex.m_Weights[i] <= 0.0f)
+					continue;
+
+				int bone_id{ sub_mesh.m_BonePalette.empty() ? vertex.m_BoneIDs[i] : sub_mesh.m_BonePalette[vertex.m_BoneIDs[i]] };
+
+				if (bone_id < 0 || bone_id >= static_cast<int>(bone_infos.size()) || !bone_infos[bone_id])
+					continue;
+
+				glm::vec3 position{ BoneSpace ? glm::vec3{ bone_infos[bone_id]->offset * glm::vec4{ vertex.m_Position, 1.0f } } : vertex.m_Position };
+				mins[bone_id] = glm::min(mins[bone_id], position);
+				maxs[bone_id] = glm::max(maxs[bone_id], position);
+			}
+		}
+	}
+
+	std::vector<CompiledModel::Bounds> bounds(bone_infos.size(), Empty());
+
+	for (size_t i = 0; i < bone_infos.size(); ++i)
+	{
+		if (mins[i].x > maxs[i].x)
+			continue;
+
+		glm::vec3 center{ (mins[i] + maxs[i]) * 0.5f };
+		bounds[i] = { mins[i], maxs[i], center, glm::length(maxs[i] - center) };
+	}
+
+	return bounds;
+}
+
+CompiledModel::Bounds BoundsBuilder::ComputeBounds(const void* Positions, size_t Count, size_t Stride)
+{
+	CompiledModel::Bounds bounds{ Empty() };
+	const std::uint8_t* positions{ static_cast<const std::uint8_t*>(Positions) };
+
+	if (!Count)
+		return bounds;
+
+	size_t i{};
+
+#ifdef BOUNDS_SSE
+	//16 byte loads read one float past each position, so the last position is left to the scalar loop
+	__m128 min0{ _mm_set1_ps(std::numeric_limits<float>::max()) }, min1{ min0 };
+	__m128 max0{ _mm_set1_ps(std::numeric_limits<float>::lowest()) }, max1{ max0 };
+
+	for (; i + 4 < Count; i += 4)
+	{
+		__m128 p0{ _mm_loadu_ps(reinterpret_cast<const float*>(positions + (i + 0) * Stride)) };
+		__m128 p1{ _mm_loadu_ps(reinterpret_cast<const float*>(positions + (i + 1) * Stride)) };
+		__m128 p2{ _mm_loadu_ps(reinterpret_cast<const float*>(positions + (i + 2) * Stride)) };
+		__m128 p3{ _mm_loadu_ps(reinterpret_cast<const float*>(positions + (i + 3) * Stride)) };
+
+		min0 = _mm_min_ps(min0, _mm_min_ps(p0, p1));
+		min1 = _mm_min_ps(min1, _mm_min_ps(p2, p3));
+		max0 = _mm_max_ps(max0, _mm_max_ps(p0, p1));
+		max1 = _mm_max_ps(max1, _mm_max_ps(p2, p3));
+	}
+
+	float min[4], max[4];
+	_mm_storeu_ps(min, _mm_min_ps(min0, min1));
+	_mm_storeu_ps(max, _mm_max_ps(max0, max1));
+
+	bounds.m_Min = glm::vec3{ min[0], min[1], min[2] };
+	bounds.m_Max = glm::vec3{ max[0], max[1], max[2] };
+#endif
+
+	for (; i < Count; ++i)
+	{
+		glm::vec3 position{ LoadPosition(positions + i * Stride) };
+		bounds.m_Min = glm::min(bounds.m_Min, position);
+		bounds.m_Max = glm::max(bounds.m_Max, position);
+	}
+
+	bounds.m_Center = (bounds.m_Min + bounds.m_Max) * 0.5f;
+
+	//sphere around the box center, tighter than the box's circumscribed sphere
+	float max_distance2{};
+	i = 0;
+
+#ifdef BOUNDS_SSE
+	__m128 center{ _mm_setr_ps(bounds.m_Center.x, bounds.m_Center.y, bounds.m_Center.z, 0.0f) };
+	__m128 xyz_mask{ _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)) };
+	__m128 distance2{ _mm_setzero_ps() };
+
+	for (; i + 1 < Count; ++i)
+	{
+		__m128 offset{ _mm_and_ps(_mm_sub_ps(_mm_loadu_ps(reinterpret_cast<const float*>(positions + i * Stride)), center), xyz_mask) };
+		__m128 squared{ _mm_mul_ps(offset, offset) };
+
+		//horizontal x + y + z, in every lane
+		squared = _mm_add_ps(squared, _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(2, 3, 0, 1)));
+		squared = _mm_add_ps(squared, _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(1, 0, 3, 2)));
+		distance2 = _mm_max_ps(distance2, squared);
+	}
+
+	max_distance2 = _mm_cvtss_f32(distance2);
+#endif
+
+	for (; i < Count; ++i)
+	{
+		glm::vec3 offset{ LoadPosition(positions + i * Stride) - bounds.m_Center };
+		max_distance2 = (std::max)(max_distance2, glm::dot(offset, offset));
+	}
+
+	bounds.m_Radius = std::sqrt(max_distance2);
+
+	return bounds;
+}
+
+CompiledModel::Bounds BoundsBuilder::ComputeBounds(const std::vector<CompiledModel::Vertex>& Vertices)
+{
+	if (Vertices.empty())
+		return Empty();
+
+	return ComputeBounds(&Vertices[0].m_Position, Vertices.size(), sizeof(CompiledModel::Vertex));
+}
+
+CompiledModel::Bounds BoundsBuilder::Merge(const CompiledModel::Bounds& Lhs, const CompiledModel::Bounds& Rhs)
+{
+	if (Lhs.m_Radius < 0.0f)
+		return Rhs;
+
+	if (Rhs.m_Radius < 0.0f)
+		return Lhs;
+
+	CompiledModel::Bounds bounds{ glm::min(Lhs.m_Min, Rhs.m_Min), glm::max(Lhs.m_Max, Rhs.m_Max), {}, 0.0f };
+	bounds.m_Center = (bounds.m_Min + bounds.m_Max) * 0.5f;
+	bounds.m_Radius = (std::max)(glm::length(Lhs.m_Center - bounds.m_Center) + Lhs.m_Radius,
+								 glm::length(Rhs.m_Center - bounds.m_Center) + Rhs.m_Radius);
+
+	//never looser than the sphere around the merged box
+	bounds.m_Radius = (std::min)(bounds.m_Radius, glm::length(bounds.m_Max - bounds.m_Min) * 0.5f);
+
+	return bounds;
+}
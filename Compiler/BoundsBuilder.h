@@ -0,0 +1,20 @@
+#pragma once
+#include "CompiledModel.h"
+
+//Bounding volumes over position streams. The min / max scan runs 4 positions per
+//iteration with SSE when available.
+class BoundsBuilder
+{
+public:
+	//Positions is the first position, Stride the distance in bytes between consecutive positions
+	static CompiledModel::Bounds ComputeBounds(const void* Positions, size_t Count, size_t Stride);
+	static CompiledModel::Bounds ComputeBounds(const std::vector<CompiledModel::Vertex>& Vertices);
+	//Conservative union, the sphere encloses both spheres
+	static CompiledModel::Bounds Merge(const CompiledModel::Bounds& Lhs, const CompiledModel::Bounds& Rhs);
+	//Box around the transformed box, sphere scaled by the largest axis scale
+	static CompiledModel::Bounds Transform(const CompiledModel::Bounds& Bounds, const glm::mat4& Transform);
+	static CompiledModel::Bounds Empty();
+	//Box of the skinned vertices each bone influences, indexed by BoneInfo id. Bind pose model space,
+	//or the bone's own space (offset applied) with BoneSpace. Bones without skinned vertices get Empty()
+	static std::vector<CompiledModel::Bounds> ComputeSkinnedBounds(CompiledModel& Mesh, bool BoneSpace);
+};
@@ -32,4 +32,14 @@ int CompiledModel::GetPrimitive()
 std::vector<CompiledModel::SubMesh>& CompiledModel::GetSubMeshes()
 {
 	return m_SubMesh;
+}
+
+void CompiledModel::SetBounds(const Bounds& Bounds)
+{
+	m_Bounds = Bounds;
+}
+
+CompiledModel::Bounds& CompiledModel::GetBounds()
+{
+	return m_Bounds;
 }
\ No newline at end of file
@@ -21,6 +21,36 @@ public:
 		float m_Weights[4];
 	};
 
+	//Per attribute streams, written instead of Vertex when vertex streams are separated
+	enum VertexStream : std::uint8_t
+	{
+		Stream_Position = 1 << 0,			//glm::vec3
+		Stream_NormalFrame = 1 << 1,		//NormalFrame
+		Stream_UV = 1 << 2,					//glm::vec2
+		Stream_Skin = 1 << 3				//SkinInfluence
+	};
+
+	struct NormalFrame
+	{
+		glm::vec3 m_Normal;
+		glm::vec3 m_Tangent;
+		glm::vec3 m_BiTangent;
+	};
+
+	struct SkinInfluence
+	{
+		int m_BoneIDs[4];
+		float m_Weights[4];
+	};
+
+	//Attributes a submesh actually provides, every vertex still uses the full Vertex layout
+	enum VertexAttribute : std::uint8_t
+	{
+		Attribute_Normal = 1 << 0,
+		Attribute_UV = 1 << 1,				//with tangent and bitangent
+		Attribute_Skin = 1 << 2
+	};
+
 	struct Material
 	{
 		std::pair<std::string, std::string> m_Ambient; //texture name, path
@@ -29,13 +59,104 @@ public:
 		std::pair<std::string, std::string> m_Normal;
 	};
 
+	//Cluster of up to max vertices / triangles of a submesh, for cluster culling.
+	//Culled when dot(normalize(m_ConeApex - camera_position), m_ConeAxis) >= m_ConeCutoff.
+	struct Meshlet
+	{
+		std::uint32_t m_VertexOffset;		//into SubMesh::m_MeshletVertices
+		std::uint32_t m_TriangleOffset;		//into SubMesh::m_MeshletTriangles
+		std::uint32_t m_VertexCount;
+		std::uint32_t m_TriangleCount;
+
+		glm::vec3 m_Center;
+		float m_Radius;
+		glm::vec3 m_ConeApex;
+		glm::vec3 m_ConeAxis;
+		float m_ConeCutoff;					//sin of the cone half angle, above 1 when the cone is unusable
+	};
+
+	//Axis aligned box and bounding sphere, in the same space as the vertex positions
+	struct Bounds
+	{
+		glm::vec3 m_Min;
+		glm::vec3 m_Max;
+		glm::vec3 m_Center;
+		float m_Radius;
+	};
+
+	//Index range of one source mesh inside a merged submesh, for per part culling
+	struct Part
+	{
+		std::uint32_t m_FirstIndex;
+		std::uint32_t m_IndexCount;
+		Bounds m_Bounds;
+	};
+
+	//Coarser index buffer over the same vertices as the full detail submesh
+	struct Lod
+	{
+		std::vector<GLuint> m_Indices;
+		float m_Error;						//object space deviation, screen space error = m_Error * projection scale / view distance
+	};
+
+	//One draw of a submesh, written as the instance table. Rigidly animated instances follow the
+	//animated node m_Node (a BoneInfo id): model matrix = final bone matrix of m_Node * m_Transform.
+	struct Instance
+	{
+		std::uint32_t m_SubMesh;
+		int m_Node;							//-1 when static, m_Transform is then in model space
+		glm::mat4 m_Transform;
+	};
+
+	//Node referencing a submesh
+	struct NodeInstance
+	{
+		glm::mat4 m_Transform{ 1.0f };		//node to model space in the bind pose
+		glm::mat4 m_NodeTransform{ 1.0f };	//node to m_AnimatedNode space
+		std::string m_AnimatedNode;			//closest animated node at or above the node, empty when static
+	};
+
 	struct SubMesh
 	{
 		std::vector<Vertex> m_Vertices;
-		std::vector<GLushort> m_Indices;
+		std::vector<GLuint> m_Indices;		//narrowed to 8/16/32-bit when compiled
 
 		// Submesh material
 		std::pair <std::string, Material> m_Material;
+
+		Bounds m_Bounds{};
+
+		// Source node
+		std::vector<NodeInstance> m_Instances;	//per referencing node, identity once baked / for skinned meshes
+		bool m_NodeAnimated{ false };
+		std::uint8_t m_Attributes{};
+		std::uint8_t m_MaxInfluences{};		//largest used bone slot count, lets the engine pick a 1, 2 or 4 bone skinning shader
+
+		// Local to global bone ids, empty when vertices use global BoneInfo ids
+		std::vector<int> m_BonePalette;
+
+		// Source meshes when merged, as ranges of m_Indices
+		std::vector<Part> m_Parts;
+
+		// Optional LOD chain, most detailed first
+		std::vector<Lod> m_Lods;
+
+		// Optional meshlets
+		std::vector<Meshlet> m_Meshlets;
+		std::vector<GLuint> m_MeshletVertices;			//submesh vertex ids referenced by each meshlet
+		std::vector<std::uint8_t> m_MeshletTriangles;	//3 meshlet local vertex ids per triangle
+
+		// Optional position welded mesh for shadow / depth passes
+		std::vector<GLuint> m_ShadowVertices;			//source vertex of each welded vertex
+		std::vector<GLuint> m_ShadowIndices;			//into m_ShadowVertices
+	};
+
+	//Bounds of an animation clip, sampled over its duration
+	struct AnimatedBounds
+	{
+		Bounds m_Bounds;					//whole model over the whole clip
+		std::vector<Bounds> m_Segments;		//whole model over equal time segments of the clip
+		std::vector<Bounds> m_Bones;		//per bone id, geometry the bone moves over the whole clip
 	};
 
 	CompiledModel() = default;
@@ -48,11 +169,16 @@ public:
 	void SetPrimitive(const int& Primitive);
 	int GetPrimitive();
 	std::vector<SubMesh>& GetSubMeshes();
+	void SetBounds(const Bounds& Bounds);
+	Bounds& GetBounds();
 	auto& GetBoneInfoMap() { return m_BoneInfoMap; }
+	std::unordered_map<std::string, AnimatedBounds>& GetAnimatedBounds() { return m_AnimatedBounds; }
 
 private:
 	std::vector<SubMesh> m_SubMesh;
 	int m_Type;
+	Bounds m_Bounds{};
 	std::unordered_map<std::string, BoneInfo> m_BoneInfoMap;
 	std::unordered_map<std::string, Animation> m_Animations;
+	std::unordered_map<std::string, AnimatedBounds> m_AnimatedBounds;
 };
\ No newline at end of file
@@ -0,0 +1,219 @@
+#pragma once
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <limits>
+#include "GeometryCodec.h"
+#include "Bone.h"
+
+//Per asset compile settings. Defaults apply unless a "<asset name>.options" file
+//sits next to the uncompiled asset, containing "key = value" lines ('#' starts a comment).
+struct CompilerOptions
+{
+	enum class IndexPolicy
+	{
+		NarrowestWidth,		//keep submeshes whole, pick 8/16/32-bit indices per submesh
+		Split16				//split submeshes so every chunk fits 16-bit (or 8-bit) indices
+	};
+
+	IndexPolicy m_IndexPolicy{ IndexPolicy::NarrowestWidth };
+	GeometryCodec::Codec m_GeometryCodec{ GeometryCodec::Codec::Raw };
+	bool m_SeparateStreams{ false };	//position / normal frame / UV / skin streams instead of interleaved vertices
+	bool m_MergeSubMeshes{ false };
+	bool m_ShadowMesh{ false };
+
+	bool m_Meshlets{ false };
+	size_t m_MeshletMaxVertices{ 64 };
+	size_t m_MeshletMaxTriangles{ 124 };
+
+	size_t m_MaxInfluences{ 4 };			//bone influences kept per vertex, 1 to 4
+	float m_MinInfluenceWeight{ 0.01f };	//influences below this weight are dropped before renormalising
+	size_t m_BonePaletteSize{ 0 };			//bones per submesh palette, 0 keeps global bone ids
+
+	bool m_KeyframeReduction{ false };
+	float m_KeyframeMaxError{ 0.0005f };	//largest model space deviation of key reduction or curve fitting, relative to the model's bounding radius
+	TrackEncoding m_TrackEncoding{ TrackEncoding::Keys };
+	float m_AnimationSampleRate{ 30.0f };	//samples per second of uniform and soa tracks
+	float m_NlerpMaxError{ 0.001f };		//radians, tracks where nlerp stays this close to slerp get nlerp at runtime, 0 keeps slerp
+
+	bool m_AnimationBenchmark{ false };	//times runtime sampling of every clip and prints it, nothing is stored
+
+	bool m_AnimatedBounds{ false };
+	size_t m_AnimatedBoundsSegments{ 1 };	//time segments per clip with their own bounds
+	float m_AnimatedBoundsRate{ 30.0f };	//samples per second of animation
+
+	size_t m_LodCount{ 0 };				//generated levels on top of the full detail mesh
+	float m_LodRatio{ 0.5f };			//triangle count of each level relative to the previous one
+	float m_LodMaxError{ 0.05f };		//largest deviation, relative to the submesh's bounding radius
+
+	static std::string GetOptionsPath(const std::string& asset_path)
+	{
+		return asset_path.substr(0, asset_path.find_last_of('.')) + ".options";
+	}
+
+	static CompilerOptions Load(const std::string& asset_path)
+	{
+		CompilerOptions options;
+		std::ifstream ifs{ GetOptionsPath(asset_path) };
+		std::string line;
+
+		while (std::getline(ifs, line))
+		{
+			line = line.substr(0, line.find('#'));
+			size_t separator{ line.find('=') };
+
+			if (separator == std::string::npos)
+				continue;
+
+			std::string key{ Trim(line.substr(0, separator)) };
+			std::string value{ Trim(line.substr(separator + 1)) };
+
+			if (!options.Set(key, value))
+			{
+				std::cout << "Unknown option \"" << key << " = " << value << "\" in " << GetOptionsPath(asset_path) << std::endl;
+			}
+		}
+
+		return options;
+	}
+
+private:
+
+	//lower bound of options that must be above zero
+	static constexpr float s_MinPositive{ (std::numeric_limits<float>::min)() };
+
+	bool Set(const std::string& key, const std::string& value)
+	{
+		if (key == "index_policy")
+		{
+			if (value == "narrowest")	{ m_IndexPolicy = IndexPolicy::NarrowestWidth; return true; }
+			if (value == "split16")		{ m_IndexPolicy = IndexPolicy::Split16; return true; }
+		}
+
+		else if (key == "geometry_codec")
+		{
+			if (value == "raw")			{ m_GeometryCodec = GeometryCodec::Codec::Raw; return true; }
+			if (value == "compressed")	{ m_GeometryCodec = GeometryCodec::Codec::Compressed; return true; }
+		}
+
+		else if (key == "vertex_streams")
+		{
+			if (value == "interleaved")	{ m_SeparateStreams = false; return true; }
+			if (value == "separate")	{ m_SeparateStreams = true; return true; }
+		}
+
+		else if (key == "merge_submeshes")
+			return ParseBool(value, m_MergeSubMeshes);
+
+		else if (key == "shadow_mesh")
+			return ParseBool(value, m_ShadowMesh);
+
+		else if (key == "meshlets")
+			return ParseBool(value, m_Meshlets);
+
+		else if (key == "meshlet_max_vertices")
+			return ParseNumber(value, m_MeshletMaxVertices);
+
+		else if (key == "meshlet_max_triangles")
+			return ParseNumber(value, m_MeshletMaxTriangles);
+
+		else if (key == "max_influences")
+			return ParseNumber(value, m_MaxInfluences, size_t{ 1 }, size_t{ 4 });
+
+		else if (key == "min_influence_weight")
+			return ParseNumber(value, m_MinInfluenceWeight);
+
+		else if (key == "bone_palette_size")
+			return ParseNumber(value, m_BonePaletteSize);
+
+		else if (key == "keyframe_reduction")
+			return ParseBool(value, m_KeyframeReduction);
+
+		else if (key == "keyframe_max_error")
+			return ParseNumber(value, m_KeyframeMaxError, 0.0f);
+
+		else if (key == "animation_tracks")
+		{
+			if (value == "keys")		{ m_TrackEncoding = TrackEncoding::Keys; return true; }
+			if (value == "quantized")	{ m_TrackEncoding = TrackEncoding::Quantized; return true; }
+			if (value == "uniform")		{ m_TrackEncoding = TrackEncoding::Uniform; return true; }
+			if (value == "soa")			{ m_TrackEncoding = TrackEncoding::Soa; return true; }
+			if (value == "curves")		{ m_TrackEncoding = TrackEncoding::Curves; return true; }
+			if (value == "timelines")	{ m_TrackEncoding = TrackEncoding::Timelines; return true; }
+		}
+
+		else if (key == "animation_sample_rate")
+			return ParseNumber(value, m_AnimationSampleRate, s_MinPositive);
+
+		else if (key == "nlerp_max_error")
+			return ParseNumber(value, m_NlerpMaxError, 0.0f);
+
+		else if (key == "animation_benchmark")
+			return ParseBool(value, m_AnimationBenchmark);
+
+		else if (key == "animated_bounds")
+			return ParseBool(value, m_AnimatedBounds);
+
+		else if (key == "animated_bounds_segments")
+			return ParseNumber(value, m_AnimatedBoundsSegments, size_t{ 1 });
+
+		else if (key == "animated_bounds_rate")
+			return ParseNumber(value, m_AnimatedBoundsRate, s_MinPositive);
+
+		else if (key == "lod_count")
+			return ParseNumber(value, m_LodCount);
+
+		else if (key == "lod_ratio")
+			return ParseNumber(value, m_LodRatio, s_MinPositive, 1.0f);
+
+		else if (key == "lod_max_error")
+			return ParseNumber(value, m_LodMaxError, 0.0f);
+
+		return false;
+	}
+
+	static bool ParseBool(const std::string& value, bool& result)
+	{
+		if (value == "on" || value == "true" || value == "1")	{ result = true; return true; }
+		if (value == "off" || value == "false" || value == "0")	{ result = false; return true; }
+
+		return false;
+	}
+
+	template <typename T>
+	static bool ParseNumber(const std::string& value, T& result)
+	{
+		std::istringstream iss{ value };
+		T number{};
+
+		if (!(iss >> number) || !iss.eof())
+			return false;
+
+		result = number;
+		return true;
+	}
+
+	//values outside [min, max] are rejected and leave result untouched
+	template <typename T>
+	static bool ParseNumber(const std::string& value, T& result, T min, T max = (std::numeric_limits<T>::max)())
+	{
+		T number{};
+
+		if (!ParseNumber(value, number) || number < min || number > max)
+			return false;
+
+		result = number;
+		return true;
+	}
+
+	static std::string Trim(const std::string& str)
+	{
+		size_t start{ str.find_first_not_of(" \t\r") };
+
+		if (start == std::string::npos)
+			return {};
+
+		return str.substr(start, str.find_last_not_of(" \t\r") - start + 1);
+	}
+};
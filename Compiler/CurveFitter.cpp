@@ -0,0 +1,232 @@
+#include "CurveFitter.h"
+#include "PoseEvaluator.h"
+#include "RotationAligner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+std::vector<CurveFitter::ClipReport> CurveFitter::FitCurves(CompiledModel& Mesh, float MaxError)
+{
+	auto tolerances{ KeyframeReducer::ComputeTrackTolerances(Mesh, MaxError) };
+	std::vector<ClipReport> reports(Mesh.GetAnimations().size());
+	std::vector<std::vector<Bone>> originals(reports.size());
+	std::vector<std::vector<Bone>> reduced(reports.size());
+
+	PoseEvaluator::ForEachClip(Mesh,
+							   [&](const std::string& Name, Animation& Clip, size_t Index)
+							   {
+								   ClipReport& report{ reports[Index] };
+								   report = { Name, {}, {}, {} };
+
+								   const auto& clip_tolerances{ tolerances[Name] };
+								   std::vector<Bone> bones{ Clip.GetBones() };
+								   originals[Index] = bones;
+
+								   for (auto& bone : bones)
+								   {
+									   //tracks of nodes missing from the hierarchy cannot move anything, they keep every key
+									   auto tolerance{ clip_tolerances.find(bone.GetBoneName()) };
+									   KeyframeReducer::Tolerance track_tolerance{ tolerance != clip_tolerances.end() ? tolerance->second : KeyframeReducer::Tolerance{} };
+
+									   Bone reduced_bone{ KeyframeReducer::ReduceBone(bone, track_tolerance) };
+									   bone.m_Curves = Fit(bone, track_tolerance);
+									   bone.m_Encoding = TrackEncoding::Curves;
+
+									   const CurveTrack& curves{ bone.m_Curves };
+
+									   report.m_Raw.m_Bytes += PoseEvaluator::CountKeyBytes(bone);
+									   report.m_Reduced.m_Bytes += PoseEvaluator::CountKeyBytes(reduced_bone);
+									   report.m_Curves.m_Bytes += curves.m_Positions.size() * sizeof(CurveKnot<glm::vec3>) + curves.m_Rotations.size() * sizeof(CurveKnot<glm::vec4>)
+																  + curves.m_Scales.size() * sizeof(CurveKnot<glm::vec3>);
+
+									   PoseEvaluator::MeasureKeyError(bone, [&](float Time, glm::vec3& Position, glm::quat& Rotation, glm::vec3&)
+																	  {
+																		  Position = PoseEvaluator::SamplePosition(reduced_bone, Time);
+																		  Rotation = PoseEvaluator::SampleRotation(reduced_bone, Time);
+																	  }, report.m_Reduced.m_MaxPositionError, report.m_Reduced.m_MaxRotationError);
+
+									   PoseEvaluator::MeasureKeyError(bone, [&](float Time, glm::vec3& Position, glm::quat& Rotation, glm::vec3& Scale)
+																	  {
+																		  curves.Sample(Time, Position, Rotation, Scale);
+																	  }, report.m_Curves.m_MaxPositionError, report.m_Curves.m_MaxRotationError);
+
+									   reduced[Index].push_back(std::move(reduced_bone));
+								   }
+
+								   Clip.SetBones(std::move(bones));
+							   });
+
+	//timed one clip at a time so the encodings do not compete for cores
+	size_t i{ 0 };
+
+	for (auto& [name, animation] : Mesh.GetAnimations())
+	{
+		float duration{ animation.GetDuration() };
+		auto sample_keys = [](const Bone& Track, float Time) { return PoseEvaluator::SampleLocalTransform(Track, Time); };
+
+		reports[i].m_Raw.m_SampleTime = MeasureSampleTime(originals[i], duration, sample_keys);
+		reports[i].m_Reduced.m_SampleTime = MeasureSampleTime(reduced[i], duration, sample_keys);
+		reports[i].m_Curves.m_SampleTime = MeasureSampleTime(animation.GetBones(), duration,
+															 [](const Bone& Track, float Time)
+															 {
+																 glm::vec3 position{ 0.0f }, scale{ 1.0f };
+																 glm::quat rotation{ 1.0f, 0.0f, 0.0f, 0.0f };
+
+																 Track.m_Curves.Sample(Time, position, rotation, scale);
+																 return Bone::ComposeTransform(position, rotation, scale);
+															 });
+
+		++i;
+	}
+
+	return reports;
+}
+
+CurveTrack CurveFitter::Fit(const Bone& Track, const KeyframeReducer::Tolerance& Tolerance)
+{
+	CurveTrack track;
+	std::vector<float> times;
+	std::vector<glm::vec3> vectors;
+
+	for (const auto& key : Track.m_Positions)
+	{
+		times.push_back(key.m_TimeStamp);
+		vectors.push_back(key.m_Position);
+	}
+
+	track.m_Positions = FitChannel(times, vectors, Tolerance.m_Position,
+								   [](const glm::vec3& Value, const glm::vec3& Key) { return glm::length(Value - Key); });
+
+	times.clear();
+	std::vector<glm::quat> rotations;
+
+	for (const auto& key : Track.m_Rotations)
+	{
+		times.push_back(key.m_TimeStamp);
+		rotations.push_back(glm::normalize(key.m_Orientation));
+	}
+
+	//one hemisphere, so the 4D curve between neighbours stays close to the shorter arc
+	RotationAligner::AlignTrack(rotations);
+
+	std::vector<glm::vec4> components;
+
+	for (const auto& rotation : rotations)
+		components.push_back({ rotation.x, rotation.y, rotation.z, rotation.w });
+
+	track.m_Rotations = FitChannel(times, components, Tolerance.m_Rotation,
+								   [](const glm::vec4& Value, const glm::vec4& Key)
+								   {
+									   return PoseEvaluator::RotationAngle(glm::quat{ Key.w, Key.x, Key.y, Key.z }, glm::quat{ Value.w, Value.x, Value.y, Value.z });
+								   });
+
+	times.clear();
+	vectors.clear();
+
+	for (const auto& key : Track.m_Scales)
+	{
+		times.push_back(key.m_TimeStamp);
+		vectors.push_back(key.m_Scale);
+	}
+
+	track.m_Scales = FitChannel(times, vectors, Tolerance.m_Scale,
+								[](const glm::vec3& Value, const glm::vec3& Key)
+								{
+									glm::vec3 difference{ glm::abs(Value - Key) };
+									return (std::max)({ difference.x, difference.y, difference.z });
+								});
+
+	return track;
+}
+
+template <typename T, typename Distance>
+std::vector<CurveKnot<T>> CurveFitter::FitChannel(const std::vector<float>& Times, const std::vector<T>& Values, float Tolerance, Distance Error)
+{
+	if (Values.empty())
+		return {};
+
+	//a channel that never leaves its first key is a single flat knot
+	if (std::all_of(Values.begin(), Values.end(), [&](const T& value) { return Error(Values.front(), value) <= Tolerance; }))
+		return { { Values.front(), T{ 0.0f }, Times.front() } };
+
+	size_t count{ Values.size() };
+	std::vector<CurveKnot<T>> candidates(count);
+
+	//slopes from the neighbouring keys, one sided at the ends
+	for (size_t i = 0; i < count; ++i)
+	{
+		size_t previous{ i > 0 ? i - 1 : i };
+		size_t next{ i + 1 < count ? i + 1 : i };
+		float span{ Times[next] - Times[previous] };
+
+		candidates[i] = { Values[i], span > 0.0f ? (Values[next] - Values[previous]) / span : T{ 0.0f }, Times[i] };
+	}
+
+	std::vector<bool> selected(count, false);
+	std::vector<std::pair<size_t, size_t>> spans{ { 0, count - 1 } };
+	selected.front() = selected.back() = true;
+
+	//split every span at its worst key until the curve through the span's ends fits all keys in between
+	while (!spans.empty())
+	{
+		auto [first, last] { spans.back() };
+		spans.pop_back();
+
+		size_t worst{};
+		float worst_error{ Tolerance };
+
+		for (size_t i = first + 1; i < last; ++i)
+		{
+			float error{ Error(CurveTrack::Interpolate(candidates[first], candidates[last], Times[i]), Values[i]) };
+
+			if (error > worst_error)
+			{
+				worst = i;
+				worst_error = error;
+			}
+		}
+
+		if (worst)
+		{
+			selected[worst] = true;
+			spans.push_back({ first, worst });
+			spans.push_back({ worst, last });
+		}
+	}
+
+	std::vector<CurveKnot<T>> knots;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (selected[i])
+			knots.push_back(candidates[i]);
+	}
+
+	return knots;
+}
+
+template <typename Sampler>
+double CurveFitter::MeasureSampleTime(const std::vector<Bone>& Tracks, float Duration, Sampler Sample)
+{
+	constexpr size_t sample_count{ 256 };
+
+	if (Tracks.empty())
+		return 0.0;
+
+	//summed so the samples cannot be optimised away
+	volatile float sink{};
+	auto start{ std::chrono::steady_clock::now() };
+
+	for (size_t i = 0; i < sample_count; ++i)
+	{
+		float time{ Duration * static_cast<float>(i) / static_cast<float>(sample_count - 1) };
+
+		for (const auto& track : Tracks)
+			sink = sink + Sample(track, time)[3][0];
+	}
+
+	std::chrono::duration<double, std::nano> elapsed{ std::chrono::steady_clock::now() - start };
+
+	return elapsed.count() / static_cast<double>(sample_count * Tracks.size());
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "CompiledModel.h"
+#include "KeyframeReducer.h"
+
+//Fits each channel of a bone with cubic Hermite splines within the same per-track tolerances as
+//key reduction. Knots are picked from the source keys by splitting at the worst fitting key until
+//every key is within tolerance, slopes come from the neighbouring source keys.
+class CurveFitter
+{
+public:
+	//One way of storing a clip, measured at the source key times
+	struct Encoding
+	{
+		size_t m_Bytes;
+		float m_MaxPositionError;	//local units
+		float m_MaxRotationError;	//radians
+		double m_SampleTime;		//nanoseconds per track sample, local transform included
+	};
+
+	struct ClipReport
+	{
+		std::string m_Name;
+		Encoding m_Raw;
+		Encoding m_Reduced;			//KeyframeReducer with the same error budget
+		Encoding m_Curves;
+	};
+
+	//MaxError is in model space units. Marks every bone curve encoded.
+	static std::vector<ClipReport> FitCurves(CompiledModel& Mesh, float MaxError);
+
+	static CurveTrack Fit(const Bone& Track, const KeyframeReducer::Tolerance& Tolerance);
+
+private:
+	template <typename T, typename Distance>
+	static std::vector<CurveKnot<T>> FitChannel(const std::vector<float>& Times, const std::vector<T>& Values, float Tolerance, Distance Error);
+
+	//times Sample over every track of a clip
+	template <typename Sampler>
+	static double MeasureSampleTime(const std::vector<Bone>& Tracks, float Duration, Sampler Sample);
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include "glm/gtx/quaternion.hpp"
+#include <vector>
+#include <algorithm>
+
+//Cubic Hermite knot: value and slope (per tick) at a time, the curve between two knots is the
+//Hermite cubic through both. Rotations are fitted as 4D curves in one hemisphere and normalised.
+template <typename T>
+struct CurveKnot
+{
+    T m_Value;
+    T m_Tangent;
+    float m_TimeStamp;
+};
+
+//Keys of a bone fitted with cubic Hermite splines. Knots are a subset of the source key times,
+//so a smooth stretch of dense (mocap) keys collapses to its endpoints and their slopes.
+struct CurveTrack
+{
+    std::vector<CurveKnot<glm::vec3>> m_Positions;
+    std::vector<CurveKnot<glm::vec4>> m_Rotations;      //x, y, z, w
+    std::vector<CurveKnot<glm::vec3>> m_Scales;
+
+    void Sample(float time, glm::vec3& position, glm::quat& rotation, glm::vec3& scale) const
+    {
+        if (!m_Positions.empty())
+        {
+            position = Evaluate(m_Positions, time);
+        }
+
+        if (!m_Rotations.empty())
+        {
+            glm::vec4 value{ Evaluate(m_Rotations, time) };
+            rotation = glm::normalize(glm::quat{ value.w, value.x, value.y, value.z });
+        }
+
+        if (!m_Scales.empty())
+        {
+            scale = Evaluate(m_Scales, time);
+        }
+    }
+
+    //clamps outside the first and last knot
+    template <typename T>
+    static T Evaluate(const std::vector<CurveKnot<T>>& knots, float time)
+    {
+        auto next{ std::upper_bound(knots.begin(), knots.end(), time,
+                                    [](float value, const CurveKnot<T>& knot) { return value < knot.m_TimeStamp; }) };
+
+        if (next == knots.begin())
+            return knots.front().m_Value;
+
+        if (next == knots.end())
+            return knots.back().m_Value;
+
+        return Interpolate(*(next - 1), *next, time);
+    }
+
+    template <typename T>
+    static T Interpolate(const CurveKnot<T>& from, const CurveKnot<T>& to, float time)
+    {
+        float span{ to.m_TimeStamp - from.m_TimeStamp };
+
+        if (span <= 0.0f)
+            return from.m_Value;
+
+        float t{ (time - from.m_TimeStamp) / span };
+        float t2{ t * t };
+        float t3{ t2 * t };
+
+        return from.m_Value * (2.0f * t3 - 3.0f * t2 + 1.0f) + from.m_Tangent * (span * (t3 - 2.0f * t2 + t))
+             + to.m_Value * (3.0f * t2 - 2.0f * t3) + to.m_Tangent * (span * (t3 - t2));
+    }
+};
@@ -0,0 +1,466 @@
+#include "GeometryCodec.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	std::uint32_t ZigZag(std::uint32_t delta)
+	{
+		return (delta << 1) ^ static_cast<std::uint32_t>(static_cast<std::int32_t>(delta) >> 31);
+	}
+
+	std::uint32_t UnZigZag(std::uint32_t value)
+	{
+		return (value >> 1) ^ (0u - (value & 1));
+	}
+
+	void WriteVarint(std::vector<std::uint8_t>& data, std::uint32_t value)
+	{
+		do
+		{
+			std::uint8_t byte{ static_cast<std::uint8_t>(value & 127) };
+			value >>= 7;
+			data.push_back(byte | (value ? 128 : 0));
+		} while (value);
+	}
+
+	bool ReadVarint(const std::uint8_t*& data, const std::uint8_t* end, std::uint32_t& value)
+	{
+		value = 0;
+
+		for (int shift = 0; shift < 35 && data < end; shift += 7)
+		{
+			std::uint8_t byte{ *data++ };
+			value |= static_cast<std::uint32_t>(byte & 127) << shift;
+
+			if (!(byte & 128))
+				return true;
+		}
+
+		return false;
+	}
+
+	//Index coding: every triangle gets one code byte. The high nibble references an edge of a
+	//recently coded triangle (15 = no shared edge), the low nibble says where the remaining vertex
+	//comes from: 0 = next unseen vertex, 1-14 = recently used vertex, 15 = explicit delta varint.
+	//Triangles with no shared edge code all three vertices, the last two in an extra data byte.
+	constexpr std::uint8_t s_NoEdge{ 15 };
+	constexpr std::uint8_t s_NextVertex{ 0 };
+	constexpr std::uint8_t s_ExplicitVertex{ 15 };
+
+	template <size_t EdgeFifoSize, size_t VertexFifoSize>
+	struct IndexCoderState
+	{
+		std::uint32_t m_Edges[EdgeFifoSize][2];
+		std::uint32_t m_Vertices[VertexFifoSize];
+		size_t m_EdgeHead{};
+		size_t m_VertexHead{};
+		std::uint32_t m_Next{};
+		std::uint32_t m_Last{};
+
+		IndexCoderState()
+		{
+			std::memset(m_Edges, 0xFF, sizeof(m_Edges));
+			std::memset(m_Vertices, 0xFF, sizeof(m_Vertices));
+		}
+
+		int FindEdge(std::uint32_t a, std::uint32_t b) const
+		{
+			for (size_t i = 0; i < s_NoEdge && i < EdgeFifoSize; ++i)
+			{
+				size_t index{ (m_EdgeHead - 1 - i) & (EdgeFifoSize - 1) };
+
+				if (m_Edges[index][0] == a && m_Edges[index][1] == b)
+					return static_cast<int>(i);
+			}
+
+			return -1;
+		}
+
+		const std::uint32_t* GetEdge(size_t distance) const
+		{
+			return m_Edges[(m_EdgeHead - 1 - distance) & (EdgeFifoSize - 1)];
+		}
+
+		//edges are stored reversed, as an adjacent triangle with the same winding would contain them
+		void PushEdge(std::uint32_t a, std::uint32_t b)
+		{
+			m_Edges[m_EdgeHead][0] = b;
+			m_Edges[m_EdgeHead][1] = a;
+			m_EdgeHead = (m_EdgeHead + 1) & (EdgeFifoSize - 1);
+		}
+
+		int FindVertex(std::uint32_t vertex) const
+		{
+			for (size_t i = 0; i < s_ExplicitVertex - 1 && i < VertexFifoSize; ++i)
+			{
+				if (m_Vertices[(m_VertexHead - 1 - i) & (VertexFifoSize - 1)] == vertex)
+					return static_cast<int>(i);
+			}
+
+			return -1;
+		}
+
+		std::uint32_t GetVertex(size_t distance) const
+		{
+			return m_Vertices[(m_VertexHead - 1 - distance) & (VertexFifoSize - 1)];
+		}
+
+		void PushVertex(std::uint32_t vertex)
+		{
+			m_Vertices[m_VertexHead] = vertex;
+			m_VertexHead = (m_VertexHead + 1) & (VertexFifoSize - 1);
+		}
+
+		std::uint8_t EncodeVertex(std::uint32_t vertex, std::vector<std::uint8_t>& data)
+		{
+			if (vertex == m_Next)
+			{
+				++m_Next;
+				PushVertex(vertex);
+				return s_NextVertex;
+			}
+
+			int cached{ FindVertex(vertex) };
+
+			if (cached >= 0)
+				return static_cast<std::uint8_t>(1 + cached);
+
+			WriteVarint(data, ZigZag(vertex - m_Last));
+			m_Last = vertex;
+			PushVertex(vertex);
+			return s_ExplicitVertex;
+		}
+
+		bool DecodeVertex(std::uint8_t code, const std::uint8_t*& data, const std::uint8_t* end, std::uint32_t& vertex)
+		{
+			if (code == s_NextVertex)
+			{
+				vertex = m_Next++;
+				PushVertex(vertex);
+				return true;
+			}
+
+			if (code != s_ExplicitVertex)
+			{
+				vertex = GetVertex(code - 1);
+				return true;
+			}
+
+			std::uint32_t delta{};
+
+			if (!ReadVarint(data, end, delta))
+				return false;
+
+			vertex = m_Last + UnZigZag(delta);
+			m_Last = vertex;
+			PushVertex(vertex);
+			return true;
+		}
+	};
+
+	//Vertex byte streams are coded in groups of 16 bytes, each packed with 0, 2, 4 or 8 bits per byte.
+	//The 2-bit group modes are stored up front, four groups per header byte.
+	constexpr std::uint8_t s_GroupBits[4]{ 0, 2, 4, 8 };
+
+	void EncodeByteStream(const std::uint8_t* bytes, size_t count, size_t group_size, std::vector<std::uint8_t>& data)
+	{
+		size_t num_groups{ count / group_size };
+		size_t header{ data.size() };
+		data.resize(data.size() + (num_groups + 3) / 4, 0);
+
+		for (size_t group = 0; group < num_groups; ++group)
+		{
+			const std::uint8_t* group_bytes{ bytes + group * group_size };
+			std::uint8_t max_byte{ *std::max_element(group_bytes, group_bytes + group_size) };
+			std::uint8_t mode{ static_cast<std::uint8_t>(max_byte == 0 ? 0 : max_byte < 4 ? 1 : max_byte < 16 ? 2 : 3) };
+			std::uint8_t bits{ s_GroupBits[mode] };
+
+			data[header + group / 4] |= mode << ((group % 4) * 2);
+
+			if (bits == 8)
+			{
+				data.insert(data.end(), group_bytes, group_bytes + group_size);
+				continue;
+			}
+
+			for (size_t i = 0; bits && i < group_size; i += 8 / bits)
+			{
+				std::uint8_t packed{};
+
+				for (size_t j = 0; j < 8u / bits; ++j)
+					packed |= group_bytes[i + j] << (j * bits);
+
+				data.push_back(packed);
+			}
+		}
+	}
+
+	const std::uint8_t* DecodeByteStream(std::uint8_t* bytes, size_t count, size_t group_size, const std::uint8_t* data, const std::uint8_t* end)
+	{
+		size_t num_groups{ count / group_size };
+		const std::uint8_t* header{ data };
+		data += (num_groups + 3) / 4;
+
+		if (data > end)
+			return nullptr;
+
+		for (size_t group = 0; group < num_groups; ++group)
+		{
+			std::uint8_t* group_bytes{ bytes + group * group_size };
+			std::uint8_t bits{ s_GroupBits[(header[group / 4] >> ((group % 4) * 2)) & 3] };
+			size_t packed_size{ group_size * bits / 8 };
+
+			if (data + packed_size > end)
+				return nullptr;
+
+			switch (bits)
+			{
+			case 0:
+				std::memset(group_bytes, 0, group_size);
+				break;
+			case 8:
+				std::memcpy(group_bytes, data, group_size);
+				break;
+			case 4:
+				for (size_t i = 0; i < packed_size; ++i)
+				{
+					group_bytes[i * 2 + 0] = data[i] & 15;
+					group_bytes[i * 2 + 1] = data[i] >> 4;
+				}
+				break;
+			default:
+				for (size_t i = 0; i < packed_size; ++i)
+				{
+					group_bytes[i * 4 + 0] = data[i] & 3;
+					group_bytes[i * 4 + 1] = (data[i] >> 2) & 3;
+					group_bytes[i * 4 + 2] = (data[i] >> 4) & 3;
+					group_bytes[i * 4 + 3] = data[i] >> 6;
+				}
+				break;
+			}
+
+			data += packed_size;
+		}
+
+		return data;
+	}
+}
+
+std::vector<std::uint8_t> GeometryCodec::EncodeIndexBuffer(const std::uint32_t* indices, size_t index_count)
+{
+	size_t num_triangles{ index_count / 3 };
+	std::vector<std::uint8_t> codes;
+	std::vector<std::uint8_t> data;
+	IndexCoderState<s_EdgeFifoSize, s_VertexFifoSize> state;
+
+	codes.reserve(num_triangles);
+	data.reserve(num_triangles * 2);
+
+	for (size_t triangle = 0; triangle < num_triangles; ++triangle)
+	{
+		const std::uint32_t* face{ indices + triangle * 3 };
+		int edge{ -1 };
+		size_t rotation{};
+
+		//rotating a triangle keeps its winding, so any edge may be the shared one
+		for (; rotation < 3; ++rotation)
+		{
+			edge = state.FindEdge(face[rotation], face[(rotation + 1) % 3]);
+
+			if (edge >= 0)
+				break;
+		}
+
+		if (edge >= 0)
+		{
+			std::uint32_t a{ face[rotation] }, b{ face[(rotation + 1) % 3] }, c{ face[(rotation + 2) % 3] };
+			std::uint8_t vertex_code{ state.EncodeVertex(c, data) };
+
+			codes.push_back(static_cast<std::uint8_t>(edge << 4) | vertex_code);
+			state.PushEdge(b, c);
+			state.PushEdge(c, a);
+		}
+
+		else
+		{
+			std::uint32_t a{ face[0] }, b{ face[1] }, c{ face[2] };
+			std::uint8_t a_code{ state.EncodeVertex(a, data) };
+
+			size_t bc_code{ data.size() };
+			data.push_back(0);
+
+			std::uint8_t b_code{ state.EncodeVertex(b, data) };
+			std::uint8_t c_code{ state.EncodeVertex(c, data) };
+
+			codes.push_back(static_cast<std::uint8_t>(s_NoEdge << 4) | a_code);
+			data[bc_code] = static_cast<std::uint8_t>(b_code << 4) | c_code;
+			state.PushEdge(a, b);
+			state.PushEdge(b, c);
+			state.PushEdge(c, a);
+		}
+	}
+
+	std::vector<std::uint8_t> buffer;
+	buffer.reserve(1 + codes.size() + data.size());
+	buffer.push_back(s_IndexVersion);
+	buffer.insert(buffer.end(), codes.begin(), codes.end());
+	buffer.insert(buffer.end(), data.begin(), data.end());
+
+	return buffer;
+}
+
+bool GeometryCodec::DecodeIndexBuffer(void* destination, size_t index_count, size_t index_width, const std::uint8_t* buffer, size_t buffer_size)
+{
+	size_t num_triangles{ index_count / 3 };
+
+	if (buffer_size < 1 + num_triangles || buffer[0] != s_IndexVersion)
+		return false;
+
+	const std::uint8_t* codes{ buffer + 1 };
+	const std::uint8_t* data{ codes + num_triangles };
+	const std::uint8_t* end{ buffer + buffer_size };
+	IndexCoderState<s_EdgeFifoSize, s_VertexFifoSize> state;
+
+	auto write = [&](size_t index, std::uint32_t value)
+	{
+		switch (index_width)
+		{
+		case 1: static_cast<std::uint8_t*>(destination)[index] = static_cast<std::uint8_t>(value); break;
+		case 2: static_cast<std::uint16_t*>(destination)[index] = static_cast<std::uint16_t>(value); break;
+		default: static_cast<std::uint32_t*>(destination)[index] = value; break;
+		}
+	};
+
+	for (size_t triangle = 0; triangle < num_triangles; ++triangle)
+	{
+		std::uint8_t code{ codes[triangle] };
+		std::uint8_t edge{ static_cast<std::uint8_t>(code >> 4) };
+		std::uint32_t a{}, b{}, c{};
+
+		if (edge != s_NoEdge)
+		{
+			const std::uint32_t* shared{ state.GetEdge(edge) };
+			a = shared[0];
+			b = shared[1];
+
+			if (!state.DecodeVertex(code & 15, data, end, c))
+				return false;
+
+			state.PushEdge(b, c);
+			state.PushEdge(c, a);
+		}
+
+		else
+		{
+			if (!state.DecodeVertex(code & 15, data, end, a) || data >= end)
+				return false;
+
+			std::uint8_t bc_code{ *data++ };
+
+			if (!state.DecodeVertex(bc_code >> 4, data, end, b) ||
+				!state.DecodeVertex(bc_code & 15, data, end, c))
+				return false;
+
+			state.PushEdge(a, b);
+			state.PushEdge(b, c);
+			state.PushEdge(c, a);
+		}
+
+		write(triangle * 3 + 0, a);
+		write(triangle * 3 + 1, b);
+		write(triangle * 3 + 2, c);
+	}
+
+	return data == end;
+}
+
+std::vector<std::uint8_t> GeometryCodec::EncodeVertexBuffer(const void* vertices, size_t vertex_count, size_t vertex_size)
+{
+	const std::uint8_t* source{ static_cast<const std::uint8_t*>(vertices) };
+	size_t num_words{ vertex_size / 4 };
+	std::vector<std::uint32_t> previous(num_words, 0);
+	std::vector<std::uint8_t> streams(vertex_size * s_VertexBlockSize);
+	std::vector<std::uint8_t> buffer{ s_VertexVersion };
+
+	//each block is delta coded per 32-bit attribute component against the previous vertex,
+	//then transposed into one byte stream per byte of the vertex
+	for (size_t start = 0; start < vertex_count; start += s_VertexBlockSize)
+	{
+		size_t count{ (std::min)(s_VertexBlockSize, vertex_count - start) };
+		size_t padded{ (count + s_ByteGroupSize - 1) / s_ByteGroupSize * s_ByteGroupSize };
+
+		std::fill(streams.begin(), streams.end(), std::uint8_t{ 0 });
+
+		for (size_t vertex = 0; vertex < count; ++vertex)
+		{
+			const std::uint8_t* vertex_data{ source + (start + vertex) * vertex_size };
+
+			for (size_t word = 0; word < num_words; ++word)
+			{
+				std::uint32_t current{};
+				std::memcpy(&current, vertex_data + word * 4, sizeof(std::uint32_t));
+
+				std::uint32_t delta{ ZigZag(current - previous[word]) };
+				previous[word] = current;
+
+				for (size_t byte = 0; byte < 4; ++byte)
+					streams[(word * 4 + byte) * padded + vertex] = static_cast<std::uint8_t>(delta >> (byte * 8));
+			}
+		}
+
+		for (size_t stream = 0; stream < vertex_size; ++stream)
+			EncodeByteStream(&streams[stream * padded], padded, s_ByteGroupSize, buffer);
+	}
+
+	return buffer;
+}
+
+bool GeometryCodec::DecodeVertexBuffer(void* destination, size_t vertex_count, size_t vertex_size, const std::uint8_t* buffer, size_t buffer_size)
+{
+	if (buffer_size < 1 || buffer[0] != s_VertexVersion || vertex_size % 4 || vertex_size > 256)
+		return false;
+
+	std::uint8_t* target{ static_cast<std::uint8_t*>(destination) };
+	const std::uint8_t* data{ buffer + 1 };
+	const std::uint8_t* end{ buffer + buffer_size };
+	size_t num_words{ vertex_size / 4 };
+	std::uint32_t previous[64]{};
+	std::vector<std::uint8_t> streams(vertex_size * s_VertexBlockSize);
+
+	for (size_t start = 0; start < vertex_count; start += s_VertexBlockSize)
+	{
+		size_t count{ (std::min)(s_VertexBlockSize, vertex_count - start) };
+		size_t padded{ (count + s_ByteGroupSize - 1) / s_ByteGroupSize * s_ByteGroupSize };
+
+		for (size_t stream = 0; stream < vertex_size && data; ++stream)
+			data = DecodeByteStream(&streams[stream * padded], padded, s_ByteGroupSize, data, end);
+
+		if (!data)
+			return false;
+
+		//reconstruct one attribute component at a time so the byte streams are read sequentially
+		for (size_t word = 0; word < num_words; ++word)
+		{
+			const std::uint8_t* stream{ &streams[word * 4 * padded] };
+			std::uint8_t* word_data{ target + start * vertex_size + word * 4 };
+			std::uint32_t value{ previous[word] };
+
+			for (size_t vertex = 0; vertex < count; ++vertex)
+			{
+				std::uint32_t delta{ static_cast<std::uint32_t>(stream[vertex]) |
+									 static_cast<std::uint32_t>(stream[padded + vertex]) << 8 |
+									 static_cast<std::uint32_t>(stream[padded * 2 + vertex]) << 16 |
+									 static_cast<std::uint32_t>(stream[padded * 3 + vertex]) << 24 };
+
+				value += UnZigZag(delta);
+				std::memcpy(word_data + vertex * vertex_size, &value, sizeof(std::uint32_t));
+			}
+
+			previous[word] = value;
+		}
+	}
+
+	return data == end;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+//Geometry aware encoding for vertex and index buffers. Shared by the compiler (encode)
+//and the engine loader (decode). Decoding is a single forward pass with no allocations
+//besides a small per-block scratch buffer, so it stays cheap compared to reading the file.
+class GeometryCodec
+{
+public:
+	enum class Codec : std::uint8_t
+	{
+		Raw = 0,
+		Compressed = 1
+	};
+
+	//Triangle list, indices must be < vertex_count. Best results when vertices are ordered by first use.
+	static std::vector<std::uint8_t> EncodeIndexBuffer(const std::uint32_t* indices, size_t index_count);
+	//index_width is the size of each decoded index in bytes (1, 2 or 4)
+	static bool DecodeIndexBuffer(void* destination, size_t index_count, size_t index_width, const std::uint8_t* buffer, size_t buffer_size);
+
+	//vertex_size must be a multiple of 4 and at most 256 bytes
+	static std::vector<std::uint8_t> EncodeVertexBuffer(const void* vertices, size_t vertex_count, size_t vertex_size);
+	static bool DecodeVertexBuffer(void* destination, size_t vertex_count, size_t vertex_size, const std::uint8_t* buffer, size_t buffer_size);
+
+private:
+	static constexpr std::uint8_t s_IndexVersion{ 0 };
+	static constexpr std::uint8_t s_VertexVersion{ 0 };
+	static constexpr size_t s_VertexBlockSize{ 256 };
+	static constexpr size_t s_ByteGroupSize{ 16 };
+	static constexpr size_t s_EdgeFifoSize{ 16 };
+	static constexpr size_t s_VertexFifoSize{ 16 };
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <algorithm>
+
+//Key lookups shared by the runtime tracks. Keys are sorted by time and time_at(i) returns the time of key i,
+//so the same search runs over float keys, quantized frames and shared timelines.
+struct KeySearch
+{
+    //keys a cursor walks forward before switching to binary search
+    static constexpr size_t s_MaxSteps{ 4 };
+
+    //last key at or before time, the first key for earlier times
+    template <typename TimeAt>
+    static size_t Find(size_t count, float time, TimeAt time_at)
+    {
+        size_t low{ 0 };
+        size_t high{ count };
+
+        while (low < high)
+        {
+            size_t middle{ low + (high - low) / 2 };
+
+            if (time < time_at(middle))
+                high = middle;
+            else
+                low = middle + 1;
+        }
+
+        return low == 0 ? 0 : low - 1;
+    }
+
+    //Find starting from the key at cursor, forward playback only steps over the keys it passed
+    template <typename TimeAt>
+    static size_t Seek(size_t count, size_t cursor, float time, TimeAt time_at)
+    {
+        cursor = (std::min)(cursor, count - 1);
+
+        if (time >= time_at(cursor))
+        {
+            for (size_t step = 0; step < s_MaxSteps; ++step, ++cursor)
+            {
+                if (cursor + 1 == count || time < time_at(cursor + 1))
+                    return cursor;
+            }
+        }
+
+        return Find(count, time, time_at);
+    }
+
+    //where time lies between key and next, clamped to [0, 1] and 0 for keys at the same time
+    template <typename TimeAt>
+    static float Factor(size_t key, size_t next, float time, TimeAt time_at)
+    {
+        float length{ time_at(next) - time_at(key) };
+
+        return length > 0.0f ? std::clamp((time - time_at(key)) / length, 0.0f, 1.0f) : 0.0f;
+    }
+};
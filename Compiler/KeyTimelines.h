@@ -0,0 +1,86 @@
+#pragma once
+#include "glm/gtx/quaternion.hpp"
+#include "Orientation.h"
+#include "KeySearch.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+//Where one timeline stands at a given time, found once and shared by every channel keyed on it
+struct TimelineFrame
+{
+    std::uint32_t m_Key{};
+    std::uint32_t m_Next{};
+    float m_Factor{};
+};
+
+//Distinct key timestamp arrays of one clip, each stored once. Timeline i holds
+//m_Times[m_Offsets[i]] to m_Times[m_Offsets[i + 1]], channels reference it by index.
+struct KeyTimelines
+{
+    std::vector<float> m_Times;
+    std::vector<std::uint32_t> m_Offsets;       //timeline count + 1 entries
+
+    bool Empty() const { return m_Offsets.size() < 2; }
+
+    size_t Count() const { return Empty() ? 0 : m_Offsets.size() - 1; }
+
+    //frames[i] receives where timeline i stands at time. cursors[i] keeps the key found last,
+    //so forward playback only steps over the keys it passed; times outside clamp to the first / last key
+    void Evaluate(float time, std::vector<std::uint32_t>& cursors, std::vector<TimelineFrame>& frames) const
+    {
+        cursors.resize(Count());
+        frames.resize(Count());
+
+        for (size_t i = 0; i < Count(); ++i)
+        {
+            const float* begin{ m_Times.data() + m_Offsets[i] };
+            std::uint32_t count{ m_Offsets[i + 1] - m_Offsets[i] };
+            auto time_at = [begin](size_t key) { return begin[key]; };
+            std::uint32_t key{ static_cast<std::uint32_t>(KeySearch::Seek(count, cursors[i], time, time_at)) };
+            std::uint32_t next{ (std::min)(key + 1, count - 1) };
+
+            cursors[i] = key;
+            frames[i] = { key, next, KeySearch::Factor(key, next, time, time_at) };
+        }
+    }
+};
+
+//Key values of one bone on the clip's KeyTimelines, key i of a channel sits at its timeline's time i
+struct TimelineTrack
+{
+    static constexpr std::uint32_t s_NoTimeline{ 0xFFFFFFFF };     //channel without keys
+
+    std::uint32_t m_PositionTimeline{ s_NoTimeline };
+    std::uint32_t m_RotationTimeline{ s_NoTimeline };
+    std::uint32_t m_ScaleTimeline{ s_NoTimeline };
+    std::vector<glm::vec3> m_Positions;
+    std::vector<glm::quat> m_Rotations;
+    std::vector<glm::vec3> m_Scales;
+
+    //frames from KeyTimelines::Evaluate, nlerp only for tracks the compiler flagged, see Bone::m_Nlerp
+    void Sample(const std::vector<TimelineFrame>& frames, glm::vec3& position, glm::quat& rotation, glm::vec3& scale, bool nlerp = false) const
+    {
+        if (!m_Positions.empty())
+        {
+            const TimelineFrame& frame{ frames[m_PositionTimeline] };
+            position = glm::mix(m_Positions[frame.m_Key], m_Positions[frame.m_Next], frame.m_Factor);
+        }
+
+        if (!m_Rotations.empty())
+        {
+            const TimelineFrame& frame{ frames[m_RotationTimeline] };
+            const glm::quat& from{ m_Rotations[frame.m_Key] };
+            const glm::quat& to{ m_Rotations[frame.m_Next] };
+
+            rotation = Orientation::Interpolate(from, to, frame.m_Factor, nlerp);
+        }
+
+        if (!m_Scales.empty())
+        {
+            const TimelineFrame& frame{ frames[m_ScaleTimeline] };
+            scale = glm::mix(m_Scales[frame.m_Key], m_Scales[frame.m_Next], frame.m_Factor);
+        }
+    }
+};
@@ -0,0 +1,325 @@
+#include "KeyframeReducer.h"
+#include "PoseEvaluator.h"
+#include "BoundsBuilder.h"
+
+#include <algorithm>
+#include <execution>
+#include <cmath>
+
+std::vector<KeyframeReducer::ClipReport> KeyframeReducer::ReduceKeys(CompiledModel& Mesh, float MaxError)
+{
+	struct TrackJob
+	{
+		size_t m_Clip;
+		size_t m_Track;
+	};
+
+	auto& bone_info_map{ Mesh.GetBoneInfoMap() };
+	std::vector<CompiledModel::Bounds> geometry{ ComputeBoneGeometry(Mesh) };
+
+	//rotating a node with nothing below it still moves whatever gets attached to it at runtime
+	float min_reach{ Mesh.GetBounds().m_Radius > 0.0f ? Mesh.GetBounds().m_Radius * 0.01f : 0.01f };
+
+	size_t clip_count{ Mesh.GetAnimations().size() };
+	std::vector<std::vector<FlatNode>> hierarchies(clip_count);
+	std::vector<std::unordered_map<std::string, Tolerance>> tolerances(clip_count);
+	std::vector<std::vector<Bone>> originals(clip_count);
+	std::vector<std::vector<Bone>> reduced(clip_count);
+	std::vector<TrackJob> jobs;
+	size_t i{ 0 };
+
+	//same order as ForEachClip's index
+	for (auto& [name, animation] : Mesh.GetAnimations())
+	{
+		FlattenHierarchy(animation.GetRootNode(), glm::mat4{ 1.0f }, animation, geometry, bone_info_map, hierarchies[i]);
+		tolerances[i] = ComputeTolerances(hierarchies[i], MaxError, min_reach);
+		originals[i] = animation.GetBones();
+		reduced[i] = originals[i];
+
+		for (size_t j = 0; j < originals[i].size(); ++j)
+			jobs.push_back({ i, j });
+
+		++i;
+	}
+
+	std::for_each(std::execution::par, jobs.begin(), jobs.end(),
+				  [&](const TrackJob& job)
+				  {
+					  const Bone& track{ originals[job.m_Clip][job.m_Track] };
+					  auto tolerance{ tolerances[job.m_Clip].find(track.GetBoneName()) };
+
+					  //tracks of nodes missing from the hierarchy cannot move anything
+					  if (tolerance != tolerances[job.m_Clip].end())
+						  reduced[job.m_Clip][job.m_Track] = ReduceBone(track, tolerance->second);
+				  });
+
+	std::vector<ClipReport> reports(clip_count);
+
+	PoseEvaluator::ForEachClip(Mesh,
+							   [&](const std::string& Name, Animation& Clip, size_t Index)
+							   {
+								   ClipReport& report{ reports[Index] };
+								   report = { Name, 0, 0, 0, 0, 0.0f };
+
+								   auto count = [&](const std::vector<Bone>& bones, size_t& keys, size_t& bytes)
+								   {
+									   for (const auto& bone : bones)
+									   {
+										   keys += bone.m_Positions.size() + bone.m_Rotations.size() + bone.m_Scales.size();
+										   bytes += PoseEvaluator::CountKeyBytes(bone);
+									   }
+								   };
+
+								   count(originals[Index], report.m_KeysBefore, report.m_BytesBefore);
+								   count(reduced[Index], report.m_KeysAfter, report.m_BytesAfter);
+								   report.m_MaxError = MeasureError(Clip, originals[Index], reduced[Index], hierarchies[Index], bone_info_map);
+							   });
+
+	i = 0;
+
+	for (auto& [name, animation] : Mesh.GetAnimations())
+		animation.SetBones(std::move(reduced[i++]));
+
+	return reports;
+}
+
+std::unordered_map<std::string, std::unordered_map<std::string, KeyframeReducer::Tolerance>> KeyframeReducer::ComputeTrackTolerances(CompiledModel& Mesh, float MaxError)
+{
+	std::unordered_map<std::string, std::unordered_map<std::string, Tolerance>> tolerances;
+	std::vector<CompiledModel::Bounds> geometry{ ComputeBoneGeometry(Mesh) };
+	float min_reach{ Mesh.GetBounds().m_Radius > 0.0f ? Mesh.GetBounds().m_Radius * 0.01f : 0.01f };
+
+	for (auto& [name, animation] : Mesh.GetAnimations())
+	{
+		std::vector<FlatNode> hierarchy;
+		FlattenHierarchy(animation.GetRootNode(), glm::mat4{ 1.0f }, animation, geometry, Mesh.GetBoneInfoMap(), hierarchy);
+		tolerances[name] = ComputeTolerances(hierarchy, MaxError, min_reach);
+	}
+
+	return tolerances;
+}
+
+std::vector<CompiledModel::Bounds> KeyframeReducer::ComputeBoneGeometry(CompiledModel& Mesh)
+{
+	auto& bone_info_map{ Mesh.GetBoneInfoMap() };
+	std::vector<CompiledModel::Bounds> geometry{ BoundsBuilder::ComputeSkinnedBounds(Mesh, false) };
+
+	//bind pose model space geometry moved by each bone, node attached parts included
+	for (auto& sub_mesh : Mesh.GetSubMeshes())
+	{
+		if (sub_mesh.m_Attributes & CompiledModel::Attribute_Skin)
+			continue;
+
+		for (const auto& instance : sub_mesh.m_Instances)
+		{
+			auto bone{ bone_info_map.find(instance.m_AnimatedNode) };
+
+			if (!instance.m_AnimatedNode.empty() && bone != bone_info_map.end())
+				geometry[bone->second.id] = BoundsBuilder::Merge(geometry[bone->second.id], BoundsBuilder::Transform(sub_mesh.m_Bounds, instance.m_Transform));
+		}
+	}
+
+	return geometry;
+}
+
+void KeyframeReducer::FlattenHierarchy(const NodeData& Node, const glm::mat4& ParentTransform, Animation& Clip, const std::vector<CompiledModel::Bounds>& Geometry,
+									   const std::unordered_map<std::string, BoneInfo>& BoneInfoMap, std::vector<FlatNode>& Nodes)
+{
+	size_t index{ Nodes.size() };
+	glm::mat4 transform{ ParentTransform * Node.transformation };
+	float parent_scale{ (std::max)({ glm::length(glm::vec3{ ParentTransform[0] }),
+									 glm::length(glm::vec3{ ParentTransform[1] }),
+									 glm::length(glm::vec3{ ParentTransform[2] }) }) };
+
+	auto bone_info{ BoneInfoMap.find(Node.name) };
+	bool has_geometry{ bone_info != BoneInfoMap.end() && bone_info->second.id < static_cast<int>(Geometry.size()) };
+
+	Nodes.push_back({ Node.name, 1, transform, parent_scale,
+					  has_geometry ? Geometry[bone_info->second.id] : BoundsBuilder::Empty(),
+					  Clip.FindBone(Node.name) != nullptr });
+
+	for (const auto& child : Node.children)
+		FlattenHierarchy(child, transform, Clip, Geometry, BoneInfoMap, Nodes);
+
+	Nodes[index].m_SubtreeSize = Nodes.size() - index;
+}
+
+std::unordered_map<std::string, KeyframeReducer::Tolerance> KeyframeReducer::ComputeTolerances(const std::vector<FlatNode>& Nodes, float MaxError, float MinReach)
+{
+	std::unordered_map<std::string, Tolerance> tolerances;
+	std::vector<size_t> depth(Nodes.size(), 0);			//animated nodes from the root down to and including the node
+	std::vector<size_t> height(Nodes.size(), 0);		//animated nodes from the node down to its deepest leaf
+
+	for (size_t i = 0; i < Nodes.size(); ++i)
+	{
+		depth[i] += Nodes[i].m_Animated ? 1 : 0;
+
+		for (size_t child = i + 1; child < i + Nodes[i].m_SubtreeSize; child += Nodes[child].m_SubtreeSize)
+			depth[child] = depth[i];
+	}
+
+	for (size_t i = Nodes.size(); i-- > 0;)
+	{
+		size_t below{};
+
+		for (size_t child = i + 1; child < i + Nodes[i].m_SubtreeSize; child += Nodes[child].m_SubtreeSize)
+			below = (std::max)(below, height[child]);
+
+		height[i] = below + (Nodes[i].m_Animated ? 1 : 0);
+	}
+
+	for (size_t i = 0; i < Nodes.size(); ++i)
+	{
+		if (!Nodes[i].m_Animated)
+			continue;
+
+		//errors add up along a chain, so every animated node on the longest chain through this one gets an equal share,
+		//split again between its position, rotation and scale channels
+		size_t chain{ depth[i] + height[i] - 1 };
+		float budget{ MaxError / static_cast<float>(chain) / 3.0f };
+
+		glm::vec3 joint{ Nodes[i].m_BindTransform[3] };
+		float reach{};
+
+		for (size_t j = i; j < i + Nodes[i].m_SubtreeSize; ++j)
+		{
+			reach = (std::max)(reach, glm::length(glm::vec3{ Nodes[j].m_BindTransform[3] } - joint));
+
+			if (Nodes[j].m_Geometry.m_Radius >= 0.0f)
+				reach = (std::max)(reach, glm::length(Nodes[j].m_Geometry.m_Center - joint) + Nodes[j].m_Geometry.m_Radius);
+		}
+
+		reach = (std::max)(reach, MinReach);
+
+		tolerances[Nodes[i].m_Name] = { budget / (std::max)(Nodes[i].m_ParentScale, 1e-6f), budget / reach, budget / reach };
+	}
+
+	return tolerances;
+}
+
+float KeyframeReducer::MeasureError(Animation& Clip, const std::vector<Bone>& Original, const std::vector<Bone>& Reduced,
+									const std::vector<FlatNode>& Nodes, const std::unordered_map<std::string, BoneInfo>& BoneInfoMap)
+{
+	//probe points in node space: the joint, plus the corners of the geometry each node moves
+	std::vector<std::pair<int, glm::vec3>> probes;
+
+	for (const auto& node : Nodes)
+	{
+		auto bone_info{ BoneInfoMap.find(node.m_Name) };
+
+		if (bone_info == BoneInfoMap.end())
+			continue;
+
+		probes.push_back({ bone_info->second.id, glm::vec3{ 0.0f } });
+
+		if (node.m_Geometry.m_Radius < 0.0f)
+			continue;
+
+		glm::mat4 to_node{ glm::inverse(node.m_BindTransform) };
+
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			glm::vec3 point{ corner & 1 ? node.m_Geometry.m_Max.x : node.m_Geometry.m_Min.x,
+							 corner & 2 ? node.m_Geometry.m_Max.y : node.m_Geometry.m_Min.y,
+							 corner & 4 ? node.m_Geometry.m_Max.z : node.m_Geometry.m_Min.z };
+
+			probes.push_back({ bone_info->second.id, glm::vec3{ to_node * glm::vec4{ point, 1.0f } } });
+		}
+	}
+
+	std::vector<float> times;
+
+	for (const auto& bone : Original)
+	{
+		for (const auto& key : bone.m_Positions) times.push_back(key.m_TimeStamp);
+		for (const auto& key : bone.m_Rotations) times.push_back(key.m_TimeStamp);
+		for (const auto& key : bone.m_Scales) times.push_back(key.m_TimeStamp);
+	}
+
+	std::sort(times.begin(), times.end());
+	times.erase(std::unique(times.begin(), times.end()), times.end());
+
+	PoseEvaluator::TrackMap original_tracks{ PoseEvaluator::GetTracks(Original) };
+	PoseEvaluator::TrackMap reduced_tracks{ PoseEvaluator::GetTracks(Reduced) };
+	std::vector<glm::mat4> original_pose(BoneInfoMap.size() + 1, glm::mat4{ 1.0f });
+	std::vector<glm::mat4> reduced_pose(original_pose.size(), glm::mat4{ 1.0f });
+	float max_error{};
+
+	for (float time : times)
+	{
+		PoseEvaluator::ComputeGlobalTransforms(Clip.GetRootNode(), glm::mat4{ 1.0f }, time, original_tracks, BoneInfoMap, original_pose);
+		PoseEvaluator::ComputeGlobalTransforms(Clip.GetRootNode(), glm::mat4{ 1.0f }, time, reduced_tracks, BoneInfoMap, reduced_pose);
+
+		for (const auto& [bone_id, point] : probes)
+		{
+			if (bone_id >= static_cast<int>(original_pose.size()))
+				continue;
+
+			glm::vec3 original{ original_pose[bone_id] * glm::vec4{ point, 1.0f } };
+			glm::vec3 reduced{ reduced_pose[bone_id] * glm::vec4{ point, 1.0f } };
+			max_error = (std::max)(max_error, glm::length(original - reduced));
+		}
+	}
+
+	return max_error;
+}
+
+Bone KeyframeReducer::ReduceBone(const Bone& Track, const Tolerance& Tolerance)
+{
+	Bone bone{ Track };
+
+	bone.m_Positions = ReduceTrack(Track.m_Positions, Tolerance.m_Position,
+								   [](const KeyPosition& a, const KeyPosition& b, float t) { return glm::mix(a.m_Position, b.m_Position, t); },
+								   [](const glm::vec3& value, const KeyPosition& key) { return glm::length(value - key.m_Position); });
+
+	bone.m_Rotations = ReduceTrack(Track.m_Rotations, Tolerance.m_Rotation,
+								   [](const KeyRotation& a, const KeyRotation& b, float t) { return glm::normalize(glm::slerp(a.m_Orientation, b.m_Orientation, t)); },
+								   [](const glm::quat& value, const KeyRotation& key) { return PoseEvaluator::RotationAngle(key.m_Orientation, value); });
+
+	bone.m_Scales = ReduceTrack(Track.m_Scales, Tolerance.m_Scale,
+								[](const KeyScale& a, const KeyScale& b, float t) { return glm::mix(a.m_Scale, b.m_Scale, t); },
+								[](const glm::vec3& value, const KeyScale& key)
+								{
+									glm::vec3 difference{ glm::abs(value - key.m_Scale) };
+									return (std::max)({ difference.x, difference.y, difference.z });
+								});
+
+	return bone;
+}
+
+template <typename Key, typename Interpolate, typename Distance>
+std::vector<Key> KeyframeReducer::ReduceTrack(const std::vector<Key>& Keys, float Tolerance, Interpolate Lerp, Distance Error)
+{
+	if (Keys.size() <= 1)
+		return Keys;
+
+	//a track that never leaves its first key is stored as a single key
+	if (std::all_of(Keys.begin(), Keys.end(), [&](const Key& key) { return Error(Lerp(Keys.front(), Keys.front(), 0.0f), key) <= Tolerance; }))
+		return { Keys.front() };
+
+	std::vector<Key> reduced{ Keys.front() };
+	size_t anchor{ 0 };
+
+	//extend each interpolated span for as long as every skipped key stays within tolerance
+	for (size_t end = 2; end < Keys.size(); ++end)
+	{
+		bool fits{ true };
+		float span{ Keys[end].m_TimeStamp - Keys[anchor].m_TimeStamp };
+
+		for (size_t skipped = anchor + 1; skipped < end && fits; ++skipped)
+		{
+			float t{ span > 0.0f ? (Keys[skipped].m_TimeStamp - Keys[anchor].m_TimeStamp) / span : 0.0f };
+			fits = Error(Lerp(Keys[anchor], Keys[end], t), Keys[skipped]) <= Tolerance;
+		}
+
+		if (!fits)
+		{
+			anchor = end - 1;
+			reduced.push_back(Keys[anchor]);
+		}
+	}
+
+	reduced.push_back(Keys.back());
+
+	return reduced;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "CompiledModel.h"
+
+//Removes animation keys that interpolation of their neighbours reproduces within an error bound.
+//The bound is a distance in model space: each track's tolerance is derived from how far the
+//geometry and joints below its node reach, split over the animated chain it belongs to.
+class KeyframeReducer
+{
+public:
+	struct ClipReport
+	{
+		std::string m_Name;
+		size_t m_KeysBefore;
+		size_t m_KeysAfter;
+		size_t m_BytesBefore;
+		size_t m_BytesAfter;
+		float m_MaxError;			//largest measured model space deviation at the original key times
+	};
+
+	struct Tolerance
+	{
+		float m_Position;			//local units
+		float m_Rotation;			//radians
+		float m_Scale;				//absolute scale factor difference
+	};
+
+	//MaxError is in model space units, clips and tracks are reduced in parallel
+	static std::vector<ClipReport> ReduceKeys(CompiledModel& Mesh, float MaxError);
+
+	//per clip name, per animated node: the channel tolerances ReduceKeys uses, for other lossy encodings
+	static std::unordered_map<std::string, std::unordered_map<std::string, Tolerance>> ComputeTrackTolerances(CompiledModel& Mesh, float MaxError);
+	static Bone ReduceBone(const Bone& Track, const Tolerance& Tolerance);
+
+private:
+
+	//Hierarchy of a clip flattened in pre-order, subtrees are contiguous
+	struct FlatNode
+	{
+		std::string m_Name;
+		size_t m_SubtreeSize;
+		glm::mat4 m_BindTransform;	//node to model space
+		float m_ParentScale;
+		CompiledModel::Bounds m_Geometry;
+		bool m_Animated;
+	};
+
+	static std::vector<CompiledModel::Bounds> ComputeBoneGeometry(CompiledModel& Mesh);
+	static void FlattenHierarchy(const NodeData& Node, const glm::mat4& ParentTransform, Animation& Clip, const std::vector<CompiledModel::Bounds>& Geometry,
+								 const std::unordered_map<std::string, BoneInfo>& BoneInfoMap, std::vector<FlatNode>& Nodes);
+	static std::unordered_map<std::string, Tolerance> ComputeTolerances(const std::vector<FlatNode>& Nodes, float MaxError, float MinReach);
+	static float MeasureError(Animation& Clip, const std::vector<Bone>& Original, const std::vector<Bone>& Reduced,
+							  const std::vector<FlatNode>& Nodes, const std::unordered_map<std::string, BoneInfo>& BoneInfoMap);
+	template <typename Key, typename Interpolate, typename Distance>
+	static std::vector<Key> ReduceTrack(const std::vector<Key>& Keys, float Tolerance, Interpolate Lerp, Distance Error);
+};
@@ -12,14 +12,34 @@
 #include "MeshBuilder.h"
 #include "assimp/Importer.hpp"
 #include "assimp/postprocess.h"
+#include "MeshletBuilder.h"
+#include "MeshSimplifier.h"
+#include "BoundsBuilder.h"
+#include "AnimatedBoundsBuilder.h"
+#include "KeyframeReducer.h"
+#include "TrackQuantizer.h"
+#include "TrackResampler.h"
+#include "RotationAligner.h"
+#include "CurveFitter.h"
+#include "StaticChannelReducer.h"
+#include "TimelineBuilder.h"
+#include "AnimationBenchmark.h"
 
 #include <vector>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <algorithm>
+#include <execution>
+#include <cmath>
+#include <unordered_map>
+#include <cstring>
+#include <iterator>
 
-CompiledModel MeshBuilder::Build3DMesh(const std::string& File)
+CompiledModel MeshBuilder::Build3DMesh(const std::string& File, const CompilerOptions& Options)
 {
 	Assimp::Importer importer;
 	const aiScene* scene = importer.ReadFile(File, aiProcess_Triangulate |
-												   aiProcess_LimitBoneWeights |
 												   aiProcess_FindInstances |
 												   aiProcess_GenSmoothNormals |
 										 		   aiProcess_FlipUVs |
@@ -34,35 +54,228 @@ CompiledModel MeshBuilder::Build3DMesh(const std::string& File)
 	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
 		return model;
 
-	ProcessNode(scene->mRootNode, scene, model);
+	std::vector<size_t> mesh_to_sub_mesh(scene->mNumMeshes, std::numeric_limits<size_t>::max());
+	ProcessNode(scene->mRootNode, scene, model, glm::mat4{ 1.0f }, mesh_to_sub_mesh, Options);
+
+	if (Options.m_MergeSubMeshes)
+	{
+		MergeSubMeshes(model, Options.m_IndexPolicy == CompilerOptions::IndexPolicy::Split16 ? std::numeric_limits<GLushort>::max()
+																							 : std::numeric_limits<GLuint>::max());
+	}
+
+	if (Options.m_IndexPolicy == CompilerOptions::IndexPolicy::Split16)
+		SplitLargeSubMeshes(model, std::numeric_limits<GLushort>::max());
+
+	//a triangle may reference up to 3 * max_influences bones, so smaller palettes could never fit it
+	if (Options.m_BonePaletteSize)
+		BuildBonePalettes(model, (std::max)(Options.m_BonePaletteSize, 3 * Options.m_MaxInfluences));
+
+	if (Options.m_LodCount)
+		GenerateLods(model, Options);
+
+	//compressed index buffers code first-use vertices almost for free
+	if (Options.m_GeometryCodec == GeometryCodec::Codec::Compressed)
+	{
+		for (auto& sub_mesh : model.GetSubMeshes())
+			OptimizeVertexFetch(sub_mesh);
+	}
+
+	if (Options.m_ShadowMesh)
+	{
+		std::for_each(std::execution::par, model.GetSubMeshes().begin(), model.GetSubMeshes().end(), BuildShadowMesh);
+	}
+
+	if (Options.m_Meshlets)
+	{
+		std::for_each(std::execution::par, model.GetSubMeshes().begin(), model.GetSubMeshes().end(),
+					  [&](CompiledModel::SubMesh& sub_mesh)
+					  {
+						  MeshletBuilder::BuildMeshlets(sub_mesh, Options.m_MeshletMaxVertices, Options.m_MeshletMaxTriangles);
+					  });
+	}
+
+	for (auto& sub_mesh : model.GetSubMeshes())
+		CountInfluences(sub_mesh);
+
+	ComputeBounds(model);
 
 	model.SetPrimitive(GL_TRIANGLES);
 
 	LoadAnimations(scene->mAnimations, scene->mNumAnimations, scene->mRootNode, &model);
+	SortBones(model, scene->mRootNode);
+	PruneHierarchy(model);
+
+	for (const auto& report : StaticChannelReducer::ReduceStaticChannels(model))
+	{
+		std::cout << "Static channels \"" << report.m_Name << "\": " << report.m_Collapsed << " of " << report.m_Channels << " channels collapsed, "
+				  << report.m_Dropped << " dropped as bind pose, " << report.m_RemovedTracks << " tracks removed, "
+				  << report.m_BytesBefore << " -> " << report.m_BytesAfter << " bytes" << std::endl;
+	}
+
+	float max_error{ Options.m_KeyframeMaxError * (model.GetBounds().m_Radius > 0.0f ? model.GetBounds().m_Radius : 1.0f) };
+
+	//curve fitting needs the source keys, it reports against key reduction itself
+	if (Options.m_KeyframeReduction && Options.m_TrackEncoding != TrackEncoding::Curves)
+	{
+		for (const auto& report : KeyframeReducer::ReduceKeys(model, max_error))
+		{
+			std::cout << "Keyframe reduction \"" << report.m_Name << "\": " << report.m_KeysBefore << " -> " << report.m_KeysAfter << " keys, "
+					  << report.m_BytesBefore << " -> " << report.m_BytesAfter << " bytes, max error " << report.m_MaxError << std::endl;
+		}
+	}
+
+	if (Options.m_AnimatedBounds)
+		AnimatedBoundsBuilder::BuildAnimatedBounds(model, Options.m_AnimatedBoundsSegments, Options.m_AnimatedBoundsRate);
+
+	if (Options.m_TrackEncoding == TrackEncoding::Quantized)
+	{
+		for (const auto& report : TrackQuantizer::QuantizeTracks(model))
+		{
+			std::cout << "Track quantization \"" << report.m_Name << "\": " << report.m_BytesBefore << " -> " << report.m_BytesAfter << " bytes, max error "
+					  << report.m_MaxPositionError << " units / " << report.m_MaxRotationError << " radians" << std::endl;
+		}
+	}
+
+	else if (Options.m_TrackEncoding == TrackEncoding::Uniform || Options.m_TrackEncoding == TrackEncoding::Soa)
+	{
+		auto reports{ Options.m_TrackEncoding == TrackEncoding::Uniform ? TrackResampler::ResampleTracks(model, Options.m_AnimationSampleRate)
+																		: TrackResampler::ResampleClips(model, Options.m_AnimationSampleRate) };
+
+		for (const auto& report : reports)
+		{
+			std::cout << "Track resampling \"" << report.m_Name << "\": " << report.m_KeysBefore << " keys -> " << report.m_SamplesAfter << " samples, "
+					  << report.m_BytesBefore << " -> " << report.m_BytesAfter << " bytes, max error "
+					  << report.m_MaxPositionError << " units / " << report.m_MaxRotationError << " radians" << std::endl;
+		}
+	}
+
+	else if (Options.m_TrackEncoding == TrackEncoding::Curves)
+	{
+		for (const auto& report : CurveFitter::FitCurves(model, max_error))
+		{
+			std::cout << "Curve fitting \"" << report.m_Name << "\":" << std::endl;
+
+			for (const auto& [label, encoding] : { std::make_pair("raw", &report.m_Raw), std::make_pair("reduced", &report.m_Reduced), std::make_pair("curves", &report.m_Curves) })
+			{
+				std::cout << "  " << std::left << std::setw(8) << label << std::right << std::setw(10) << encoding->m_Bytes << " bytes, max error "
+						  << encoding->m_MaxPositionError << " units / " << encoding->m_MaxRotationError << " radians, "
+						  << encoding->m_SampleTime << " ns per track sample" << std::endl;
+			}
+		}
+	}
+
+	else if (Options.m_TrackEncoding == TrackEncoding::Timelines)
+	{
+		for (const auto& report : TimelineBuilder::ShareTimelines(model))
+		{
+			std::cout << "Shared timelines \"" << report.m_Name << "\": " << report.m_Channels << " channels on " << report.m_Timelines << " timelines, "
+					  << report.m_BytesBefore << " -> " << report.m_BytesAfter << " bytes" << std::endl;
+		}
+	}
+
+	if (Options.m_NlerpMaxError > 0.0f)
+	{
+		for (const auto& report : RotationAligner::AlignRotations(model, Options.m_NlerpMaxError))
+		{
+			std::cout << "Nlerp rotations \"" << report.m_Name << "\": " << report.m_NlerpTracks << " of " << report.m_Tracks << " tracks, max error "
+					  << report.m_MaxError << " radians" << std::endl;
+		}
+	}
+
+	BuildSkeletonTables(model);
+
+	if (Options.m_AnimationBenchmark)
+	{
+		for (const auto& report : AnimationBenchmark::MeasureClips(model))
+		{
+			std::cout << "Sampler benchmark \"" << report.m_Name << "\" (" << report.m_Bones << " bones, ns per bone): forward Bone::Update " << report.m_BoneForward
+					  << " / AnimationSampler " << report.m_SamplerForward << ", seeks Bone::Update " << report.m_BoneSeek
+					  << " / AnimationSampler " << report.m_SamplerSeek << ", local pose before " << report.m_ComposeBefore
+					  << " / after direct composition " << report.m_ComposeAfter << std::endl;
+		}
+	}
 
 	importer.FreeScene();
 
 	return std::move(model);
 }
 
-void MeshBuilder::ProcessNode(aiNode* Node, const aiScene* Scene, CompiledModel& Mesh)
+void MeshBuilder::ProcessNode(aiNode* Node, const aiScene* Scene, CompiledModel& Mesh, const glm::mat4& ParentTransform, std::vector<size_t>& MeshToSubMesh, const CompilerOptions& Options)
 {
+	glm::mat4 transform{ ParentTransform * ToMat4(Node->mTransformation) };
+	const aiNode* animated_node{ Node->mNumMeshes ? FindAnimatedNode(Node, Scene) : nullptr };
+
 	for (size_t i = 0; i < Node->mNumMeshes; ++i)
 	{
-		aiMesh* mesh = Scene->mMeshes[Node->mMeshes[i]];
-		Mesh.AddSubMesh(ProcessSubMesh(mesh, Scene, Mesh));
+		size_t& sub_mesh_index{ MeshToSubMesh[Node->mMeshes[i]] };
+
+		//meshes shared by several nodes (or found by aiProcess_FindInstances) are only stored once
+		if (sub_mesh_index == std::numeric_limits<size_t>::max())
+		{
+			sub_mesh_index = Mesh.GetSubMeshes().size();
+			Mesh.AddSubMesh(ProcessSubMesh(Scene->mMeshes[Node->mMeshes[i]], Scene, Mesh, Options));
+		}
+
+		auto& sub_mesh{ Mesh.GetSubMeshes()[sub_mesh_index] };
+
+		//skinning already places vertices in model space
+		bool skinned{ (sub_mesh.m_Attributes & CompiledModel::Attribute_Skin) != 0 };
+
+		CompiledModel::NodeInstance instance{};
+
+		if (!skinned)
+		{
+			instance.m_Transform = transform;
+
+			//rigidly animated meshes follow their animated node instead of being skinned
+			if (animated_node)
+			{
+				for (const aiNode* node = Node; node != animated_node; node = node->mParent)
+					instance.m_NodeTransform = ToMat4(node->mTransformation) * instance.m_NodeTransform;
+
+				instance.m_AnimatedNode = animated_node->mName.C_Str();
+				sub_mesh.m_NodeAnimated = true;
+			}
+		}
+
+		sub_mesh.m_Instances.push_back(instance);
 	}
 
 	for (size_t i = 0; i < Node->mNumChildren; ++i)
 	{
-		ProcessNode(Node->mChildren[i], Scene, Mesh);
+		ProcessNode(Node->mChildren[i], Scene, Mesh, transform, MeshToSubMesh, Options);
 	}
 }
 
-CompiledModel::SubMesh MeshBuilder::ProcessSubMesh(aiMesh* SubMesh, const aiScene* Scene, CompiledModel& Mesh)
+const aiNode* MeshBuilder::FindAnimatedNode(const aiNode* Node, const aiScene* Scene)
+{
+	for (; Node; Node = Node->mParent)
+	{
+		for (size_t i = 0; i < Scene->mNumAnimations; ++i)
+		{
+			for (size_t j = 0; j < Scene->mAnimations[i]->mNumChannels; ++j)
+			{
+				if (Scene->mAnimations[i]->mChannels[j]->mNodeName == Node->mName)
+					return Node;
+			}
+		}
+	}
+
+	return nullptr;
+}
+
+glm::mat4 MeshBuilder::ToMat4(const aiMatrix4x4& Matrix)
+{
+	return { Matrix.a1, Matrix.b1, Matrix.c1, Matrix.d1,
+			 Matrix.a2, Matrix.b2, Matrix.c2, Matrix.d2,
+			 Matrix.a3, Matrix.b3, Matrix.c3, Matrix.d3,
+			 Matrix.a4, Matrix.b4, Matrix.c4, Matrix.d4 };
+}
+
+CompiledModel::SubMesh MeshBuilder::ProcessSubMesh(aiMesh* SubMesh, const aiScene* Scene, CompiledModel& Mesh, const CompilerOptions& Options)
 {
 	std::vector<CompiledModel::Vertex> vertices;
-	std::vector<GLushort> index;
+	std::vector<GLuint> index;
 
 	for (size_t i = 0; i < SubMesh->mNumVertices; ++i)
 	{
@@ -98,10 +311,10 @@ CompiledModel::SubMesh MeshBuilder::ProcessSubMesh(aiMesh* SubMesh, const aiScen
 		aiFace face = SubMesh->mFaces[i];
 
 		for (size_t j = 0; j < face.mNumIndices; ++j)
-			index.push_back(static_cast<GLushort>(face.mIndices[j]));
+			index.push_back(static_cast<GLuint>(face.mIndices[j]));
 	}
 
-	ExtractVertexBoneWeight(vertices, SubMesh, Mesh);
+	ExtractVertexBoneWeight(vertices, SubMesh, Mesh, Options);
 
 	aiString str;
 	aiMaterial* material = Scene->mMaterials[SubMesh->mMaterialIndex];
@@ -109,12 +322,18 @@ CompiledModel::SubMesh MeshBuilder::ProcessSubMesh(aiMesh* SubMesh, const aiScen
 	
 	auto material_data = LoadMaterial(str.C_Str(), material);
 
-	return std::move(CompiledModel::SubMesh{ vertices, index, material_data });
+	CompiledModel::SubMesh sub_mesh{ vertices, index, material_data };
+	sub_mesh.m_Attributes = static_cast<std::uint8_t>((SubMesh->HasNormals() ? CompiledModel::Attribute_Normal : 0) |
+													  (SubMesh->mTextureCoords[0] ? CompiledModel::Attribute_UV : 0) |
+													  (SubMesh->HasBones() ? CompiledModel::Attribute_Skin : 0));
+
+	return sub_mesh;
 }
 
-void MeshBuilder::ExtractVertexBoneWeight(std::vector<CompiledModel::Vertex>& Vertices, aiMesh* SubMesh, CompiledModel& Mesh)
+void MeshBuilder::ExtractVertexBoneWeight(std::vector<CompiledModel::Vertex>& Vertices, aiMesh* SubMesh, CompiledModel& Mesh, const CompilerOptions& Options)
 {
 	auto& bone_info_map{ Mesh.GetBoneInfoMap() };
+	std::vector<std::vector<std::pair<float, int>>> influences(Vertices.size());	//weight, bone id
 
 	for (size_t bone_index = 0; bone_index < SubMesh->mNumBones; ++bone_index)
 	{
@@ -145,23 +364,57 @@ void MeshBuilder::ExtractVertexBoneWeight(std::vector<CompiledModel::Vertex>& Ve
 
 		for (size_t weight_index = 0; weight_index < num_weights; ++weight_index)
 		{
-			size_t vertex_id{ weights[weight_index].mVertexId };
-			float weight{ weights[weight_index].mWeight };
+			if (weights[weight_index].mWeight > 0.0f)
+				influences[weights[weight_index].mVertexId].push_back({ weights[weight_index].mWeight, bone_id });
+		}
+	}
 
-			for (int i = 0; i < 4; ++i)
-			{
-				//checks if there isn't data in the current slot
-				if (Vertices[vertex_id].m_BoneIDs[i] == -1)
-				{
-					Vertices[vertex_id].m_Weights[i] = weight;
-					Vertices[vertex_id].m_BoneIDs[i] = bone_id;
-					break;
-				}
-			}
+	size_t max_influences{ (std::min)(Options.m_MaxInfluences, size_t{ 4 }) };
+
+	for (size_t vertex_id = 0; vertex_id < Vertices.size(); ++vertex_id)
+	{
+		auto& vertex_influences{ influences[vertex_id] };
+
+		if (vertex_influences.empty())
+			continue;
+
+		//largest first, so shaders using fewer bones read the slots that matter most
+		std::sort(vertex_influences.begin(), vertex_influences.end(),
+				  [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second); });
+
+		size_t kept{ 1 };	//the strongest influence survives any threshold
+
+		while (kept < (std::min)(vertex_influences.size(), max_influences) && vertex_influences[kept].first >= Options.m_MinInfluenceWeight)
+			++kept;
+
+		float total{};
+
+		for (size_t i = 0; i < kept; ++i)
+			total += vertex_influences[i].first;
+
+		for (size_t i = 0; i < kept; ++i)
+		{
+			Vertices[vertex_id].m_Weights[i] = vertex_influences[i].first / total;
+			Vertices[vertex_id].m_BoneIDs[i] = vertex_influences[i].second;
 		}
 	}
 }
 
+void MeshBuilder::CountInfluences(CompiledModel::SubMesh& SubMesh)
+{
+	SubMesh.m_MaxInfluences = 0;
+
+	for (const auto& vertex : SubMesh.m_Vertices)
+	{
+		std::uint8_t count{};
+
+		while (count < 4 && vertex.m_BoneIDs[count] != -1)
+			++count;
+
+		SubMesh.m_MaxInfluences = (std::max)(SubMesh.m_MaxInfluences, count);
+	}
+}
+
 void MeshBuilder::LoadAnimations(aiAnimation** animation, int num_animations, aiNode* root_node, CompiledModel* model)
 {
 	if (animation)
@@ -173,6 +426,172 @@ void MeshBuilder::LoadAnimations(aiAnimation** animation, int num_animations, ai
 	}
 }
 
+void MeshBuilder::SortBones(CompiledModel& Mesh, const aiNode* Root)
+{
+	auto& bone_info_map{ Mesh.GetBoneInfoMap() };
+
+	if (bone_info_map.empty())
+		return;
+
+	int max_id{};
+
+	for (const auto& [name, bone_info] : bone_info_map)
+		max_id = (std::max)(max_id, bone_info.id);
+
+	std::vector<int> remap(max_id + 1, -1);
+	std::vector<bool> in_use(max_id + 1, false);
+
+	for (const auto& [name, bone_info] : bone_info_map)
+		in_use[bone_info.id] = true;
+	int next_id{};
+
+	//skeleton pre-order, so every parent bone comes before its children
+	std::vector<const aiNode*> stack{ Root };
+
+	while (!stack.empty())
+	{
+		const aiNode* node{ stack.back() };
+		stack.pop_back();
+
+		auto bone{ bone_info_map.find(node->mName.C_Str()) };
+
+		if (bone != bone_info_map.end() && remap[bone->second.id] == -1)
+			remap[bone->second.id] = next_id++;
+
+		for (size_t i = node->mNumChildren; i > 0; --i)
+			stack.push_back(node->mChildren[i - 1]);
+	}
+
+	//bones missing from the hierarchy go last, in their previous order
+	for (size_t id = 0; id < remap.size(); ++id)
+	{
+		if (in_use[id] && remap[id] == -1)
+			remap[id] = next_id++;
+	}
+
+	for (auto& [name, bone_info] : bone_info_map)
+		bone_info.id = remap[bone_info.id];
+
+	for (auto& sub_mesh : Mesh.GetSubMeshes())
+	{
+		if (!sub_mesh.m_BonePalette.empty())
+		{
+			for (auto& bone_id : sub_mesh.m_BonePalette)
+				bone_id = remap[bone_id];
+
+			continue;
+		}
+
+		for (auto& vertex : sub_mesh.m_Vertices)
+		{
+			for (auto& bone_id : vertex.m_BoneIDs)
+			{
+				if (bone_id != -1)
+					bone_id = remap[bone_id];
+			}
+		}
+	}
+
+	for (auto& [name, animation] : Mesh.GetAnimations())
+		animation.RemapBoneIDs(remap);
+}
+
+void MeshBuilder::PruneHierarchy(CompiledModel& Mesh)
+{
+	for (auto& [name, animation] : Mesh.GetAnimations())
+	{
+		NodeData& root{ animation.GetRootNode() };
+		std::vector<NodeData> children;
+
+		//the root always stays so the hierarchy keeps a single entry point
+		for (auto& child : root.children)
+		{
+			auto survivors{ PruneNode(child, Mesh.GetBoneInfoMap(), animation) };
+			children.insert(children.end(), std::make_move_iterator(survivors.begin()), std::make_move_iterator(survivors.end()));
+		}
+
+		root.children = std::move(children);
+	}
+}
+
+void MeshBuilder::BuildSkeletonTables(CompiledModel& Mesh)
+{
+	const auto& bone_info_map{ Mesh.GetBoneInfoMap() };
+	int bone_slots{};
+
+	for (const auto& [name, bone_info] : bone_info_map)
+		bone_slots = (std::max)(bone_slots, bone_info.id + 1);
+
+	for (auto& [name, animation] : Mesh.GetAnimations())
+	{
+		std::unordered_map<std::string, std::int32_t> tracks;
+
+		for (size_t i = 0; i < animation.GetBones().size(); ++i)
+			tracks[animation.GetBones()[i].GetBoneName()] = static_cast<std::int32_t>(i);
+
+		SkeletonTable skeleton;
+		skeleton.m_Offsets.resize(bone_slots, glm::mat4{ 1.0f });
+
+		for (const auto& [bone_name, bone_info] : bone_info_map)
+			skeleton.m_Offsets[bone_info.id] = bone_info.offset;
+
+		FlattenSkeleton(animation.GetRootNode(), -1, tracks, bone_info_map, skeleton);
+		animation.SetSkeleton(std::move(skeleton));
+	}
+}
+
+void MeshBuilder::FlattenSkeleton(const NodeData& Node, std::int32_t Parent, const std::unordered_map<std::string, std::int32_t>& Tracks,
+								  const std::unordered_map<std::string, BoneInfo>& BoneInfoMap, SkeletonTable& Skeleton)
+{
+	auto track{ Tracks.find(Node.name) };
+	auto bone_info{ BoneInfoMap.find(Node.name) };
+	std::int32_t index{ static_cast<std::int32_t>(Skeleton.m_Nodes.size()) };
+
+	Skeleton.m_Nodes.push_back({ Parent,
+								 track != Tracks.end() ? track->second : -1,
+								 bone_info != BoneInfoMap.end() ? bone_info->second.id : -1,
+								 Node.transformation });
+
+	for (const auto& child : Node.children)
+		FlattenSkeleton(child, index, Tracks, BoneInfoMap, Skeleton);
+}
+
+std::vector<NodeData> MeshBuilder::PruneNode(NodeData& Node, const std::unordered_map<std::string, BoneInfo>& BoneInfoMap, Animation& Clip)
+{
+	std::vector<NodeData> children;
+
+	for (auto& child : Node.children)
+	{
+		auto survivors{ PruneNode(child, BoneInfoMap, Clip) };
+		children.insert(children.end(), std::make_move_iterator(survivors.begin()), std::make_move_iterator(survivors.end()));
+	}
+
+	Node.children = std::move(children);
+
+	//bones and animated nodes (animated $AssimpFbx$ pivots included) are looked up by name at runtime
+	bool keep{ BoneInfoMap.find(Node.name) != BoneInfoMap.end() };
+
+	//an animated child replaces its own transform every frame, so a non identity parent cannot fold into it
+	if (!keep && Node.transformation != glm::mat4{ 1.0f })
+	{
+		keep = std::any_of(Node.children.begin(), Node.children.end(),
+						   [&](const NodeData& child) { return Clip.FindBone(child.name) != nullptr; });
+	}
+
+	if (keep)
+	{
+		std::vector<NodeData> survivor;
+		survivor.push_back(std::move(Node));
+		return survivor;
+	}
+
+	//static helpers (pivot chains, empty groups) fold into the nodes below them, or vanish with nothing below
+	for (auto& child : Node.children)
+		child.transformation = Node.transformation * child.transformation;
+
+	return std::move(Node.children);
+}
+
 std::pair <std::string, CompiledModel::Material> MeshBuilder::LoadMaterial(const std::string& Material, aiMaterial* AiMat)
 {
 	std::pair <std::string, CompiledModel::Material> mat_data;
@@ -217,4 +636,439 @@ std::pair <std::string, CompiledModel::Material> MeshBuilder::LoadMaterial(const
 	mat_data.second.m_Normal = { filename, {"../../resources/textures/" + filename } };
 	
 	return mat_data;
+}
+
+void MeshBuilder::SplitLargeSubMeshes(CompiledModel& Mesh, size_t MaxVertices)
+{
+	std::vector<CompiledModel::SubMesh> sub_meshes;
+	sub_meshes.swap(Mesh.GetSubMeshes());
+
+	for (auto& sub_mesh : sub_meshes)
+	{
+		if (sub_mesh.m_Vertices.size() <= MaxVertices)
+		{
+			Mesh.AddSubMesh(sub_mesh);
+			continue;
+		}
+
+		for (auto& chunk : SplitSubMesh(sub_mesh, MaxVertices))
+			Mesh.AddSubMesh(chunk);
+	}
+}
+
+std::vector<CompiledModel::SubMesh> MeshBuilder::SplitSubMesh(const CompiledModel::SubMesh& SubMesh, size_t MaxVertices, size_t MaxBones)
+{
+	std::vector<CompiledModel::SubMesh> chunks;
+	std::vector<GLuint> remap(SubMesh.m_Vertices.size(), std::numeric_limits<GLuint>::max());
+	std::vector<GLuint> used;												//original vertex ids remapped by the current chunk
+	std::vector<int> bones;													//bone ids referenced by the current chunk
+	std::vector<int> new_bones;
+	CompiledModel::SubMesh empty{ {}, {}, SubMesh.m_Material };
+	empty.m_Instances = SubMesh.m_Instances;
+	empty.m_NodeAnimated = SubMesh.m_NodeAnimated;
+	empty.m_Attributes = SubMesh.m_Attributes;
+
+	CompiledModel::SubMesh chunk{ empty };
+	size_t chunk_first{};													//source index of the current chunk's first index
+	std::vector<glm::vec3> part_positions;
+
+	auto flush = [&]()
+	{
+		//chunks hold consecutive runs of the source triangles, so merged part ranges are cut at chunk boundaries
+		for (const auto& part : SubMesh.m_Parts)
+		{
+			size_t first{ (std::max)(static_cast<size_t>(part.m_FirstIndex), chunk_first) };
+			size_t last{ (std::min)(static_cast<size_t>(part.m_FirstIndex) + part.m_IndexCount, chunk_first + chunk.m_Indices.size()) };
+
+			if (first >= last)
+				continue;
+
+			part_positions.clear();
+
+			for (size_t i = first - chunk_first; i < last - chunk_first; ++i)
+				part_positions.push_back(chunk.m_Vertices[chunk.m_Indices[i]].m_Position);
+
+			chunk.m_Parts.push_back({ static_cast<std::uint32_t>(first - chunk_first), static_cast<std::uint32_t>(last - first),
+									  BoundsBuilder::ComputeBounds(part_positions.data(), part_positions.size(), sizeof(glm::vec3)) });
+		}
+
+		//a single part needs no range table
+		if (chunk.m_Parts.size() == 1)
+			chunk.m_Parts.clear();
+
+		chunk_first += chunk.m_Indices.size();
+
+		for (GLuint vertex_id : used)
+			remap[vertex_id] = std::numeric_limits<GLuint>::max();
+
+		used.clear();
+		bones.clear();
+		chunks.push_back(std::move(chunk));
+		chunk = empty;
+	};
+
+	auto collect_new_bones = [&](size_t first_index)
+	{
+		new_bones.clear();
+
+		for (size_t j = 0; j < 3; ++j)
+		{
+			const auto& vertex{ SubMesh.m_Vertices[SubMesh.m_Indices[first_index + j]] };
+
+			for (int bone_id : vertex.m_BoneIDs)
+			{
+				if (bone_id != -1 &&
+					std::find(bones.begin(), bones.end(), bone_id) == bones.end() &&
+					std::find(new_bones.begin(), new_bones.end(), bone_id) == new_bones.end())
+				{
+					new_bones.push_back(bone_id);
+				}
+			}
+		}
+	};
+
+	//greedily fill each chunk with whole triangles, in their original order
+	for (size_t i = 0; i + 2 < SubMesh.m_Indices.size(); i += 3)
+	{
+		size_t new_vertices{};
+
+		for (size_t j = 0; j < 3; ++j)
+		{
+			if (remap[SubMesh.m_Indices[i + j]] == std::numeric_limits<GLuint>::max())
+				++new_vertices;
+		}
+
+		if (MaxBones != std::numeric_limits<size_t>::max())
+			collect_new_bones(i);
+
+		if (chunk.m_Vertices.size() + new_vertices > MaxVertices || bones.size() + new_bones.size() > MaxBones)
+		{
+			flush();
+
+			if (MaxBones != std::numeric_limits<size_t>::max())
+				collect_new_bones(i);
+		}
+
+		bones.insert(bones.end(), new_bones.begin(), new_bones.end());
+
+		for (size_t j = 0; j < 3; ++j)
+		{
+			GLuint vertex_id{ SubMesh.m_Indices[i + j] };
+
+			if (remap[vertex_id] == std::numeric_limits<GLuint>::max())
+			{
+				remap[vertex_id] = static_cast<GLuint>(chunk.m_Vertices.size());
+				chunk.m_Vertices.push_back(SubMesh.m_Vertices[vertex_id]);
+				used.push_back(vertex_id);
+			}
+
+			chunk.m_Indices.push_back(remap[vertex_id]);
+		}
+	}
+
+	if (!chunk.m_Indices.empty())
+		flush();
+
+	return chunks;
+}
+
+void MeshBuilder::BuildBonePalettes(CompiledModel& Mesh, size_t MaxBones)
+{
+	std::vector<CompiledModel::SubMesh> sub_meshes;
+	sub_meshes.swap(Mesh.GetSubMeshes());
+
+	for (auto& sub_mesh : sub_meshes)
+	{
+		if (!(sub_mesh.m_Attributes & CompiledModel::Attribute_Skin))
+		{
+			Mesh.AddSubMesh(sub_mesh);
+			continue;
+		}
+
+		std::vector<CompiledModel::SubMesh> chunks{ SplitSubMesh(sub_mesh, std::numeric_limits<size_t>::max(), MaxBones) };
+
+		for (auto& chunk : chunks)
+		{
+			LocalizeBones(chunk);
+			Mesh.AddSubMesh(chunk);
+		}
+	}
+}
+
+void MeshBuilder::LocalizeBones(CompiledModel::SubMesh& SubMesh)
+{
+	std::unordered_map<int, int> local_ids;
+	SubMesh.m_BonePalette.clear();
+
+	for (auto& vertex : SubMesh.m_Vertices)
+	{
+		for (int& bone_id : vertex.m_BoneIDs)
+		{
+			if (bone_id == -1)
+				continue;
+
+			auto [it, inserted] = local_ids.try_emplace(bone_id, static_cast<int>(SubMesh.m_BonePalette.size()));
+
+			if (inserted)
+				SubMesh.m_BonePalette.push_back(bone_id);
+
+			bone_id = it->second;
+		}
+	}
+}
+
+void MeshBuilder::OptimizeVertexFetch(CompiledModel::SubMesh& SubMesh)
+{
+	std::vector<GLuint> remap(SubMesh.m_Vertices.size(), std::numeric_limits<GLuint>::max());
+	std::vector<CompiledModel::Vertex> vertices;
+	vertices.reserve(SubMesh.m_Vertices.size());
+
+	//order vertices by first use, dropping any that no triangle references
+	for (auto& index : SubMesh.m_Indices)
+	{
+		if (remap[index] == std::numeric_limits<GLuint>::max())
+		{
+			remap[index] = static_cast<GLuint>(vertices.size());
+			vertices.push_back(SubMesh.m_Vertices[index]);
+		}
+
+		index = remap[index];
+	}
+
+	//coarser levels only reference vertices of the full detail level
+	for (auto& lod : SubMesh.m_Lods)
+	{
+		for (auto& index : lod.m_Indices)
+			index = remap[index];
+	}
+
+	SubMesh.m_Vertices.swap(vertices);
+}
+
+void MeshBuilder::BuildShadowMesh(CompiledModel::SubMesh& SubMesh)
+{
+	//vertices split only by normal / UV seams are the same vertex to a depth only pass.
+	//Skinned vertices also need matching influences, or the welded vertex would deform differently.
+	struct WeldKey
+	{
+		std::uint32_t m_Bits[11];
+
+		bool operator==(const WeldKey& Other) const
+		{
+			return std::equal(std::begin(m_Bits), std::end(m_Bits), std::begin(Other.m_Bits));
+		}
+	};
+
+	struct WeldKeyHash
+	{
+		size_t operator()(const WeldKey& Key) const
+		{
+			size_t hash{ 0 };
+
+			for (auto bits : Key.m_Bits)
+				hash = hash * 0x9E3779B1u ^ bits;
+
+			return hash;
+		}
+	};
+
+	bool skinned{ (SubMesh.m_Attributes & CompiledModel::Attribute_Skin) != 0 };
+	std::unordered_map<WeldKey, GLuint, WeldKeyHash> welded;
+	welded.reserve(SubMesh.m_Vertices.size());
+
+	SubMesh.m_ShadowVertices.clear();
+	SubMesh.m_ShadowIndices.clear();
+	SubMesh.m_ShadowIndices.reserve(SubMesh.m_Indices.size());
+
+	for (auto index : SubMesh.m_Indices)
+	{
+		const auto& vertex{ SubMesh.m_Vertices[index] };
+		WeldKey key{};
+
+		for (int i = 0; i < 3; ++i)
+		{
+			float component{ vertex.m_Position[i] + 0.0f };	//-0 and +0 weld together
+			std::memcpy(&key.m_Bits[i], &component, sizeof(float));
+		}
+
+		if (skinned)
+		{
+			std::memcpy(&key.m_Bits[3], vertex.m_BoneIDs, sizeof(vertex.m_BoneIDs));
+			std::memcpy(&key.m_Bits[7], vertex.m_Weights, sizeof(vertex.m_Weights));
+		}
+
+		//welded vertices are numbered by first use, which keeps the shadow index buffer cache friendly
+		auto [it, inserted] = welded.try_emplace(key, static_cast<GLuint>(SubMesh.m_ShadowVertices.size()));
+
+		if (inserted)
+			SubMesh.m_ShadowVertices.push_back(index);
+
+		SubMesh.m_ShadowIndices.push_back(it->second);
+	}
+}
+
+void MeshBuilder::GenerateLods(CompiledModel& Mesh, const CompilerOptions& Options)
+{
+	struct LodJob
+	{
+		CompiledModel::SubMesh* m_SubMesh;
+		size_t m_Level;
+		float m_Radius;
+	};
+
+	std::vector<LodJob> jobs;
+
+	for (auto& sub_mesh : Mesh.GetSubMeshes())
+	{
+		glm::vec3 min{ std::numeric_limits<float>::max() }, max{ std::numeric_limits<float>::lowest() };
+
+		for (const auto& vertex : sub_mesh.m_Vertices)
+		{
+			min = glm::min(min, vertex.m_Position);
+			max = glm::max(max, vertex.m_Position);
+		}
+
+		sub_mesh.m_Lods.assign(Options.m_LodCount, {});
+
+		for (size_t level = 0; level < Options.m_LodCount; ++level)
+			jobs.push_back({ &sub_mesh, level, glm::length(max - min) * 0.5f });
+	}
+
+	//every level is simplified from the full detail mesh, so submeshes and levels run independently
+	std::for_each(std::execution::par, jobs.begin(), jobs.end(),
+				  [&](const LodJob& job)
+				  {
+					  const std::vector<GLuint>& indices{ job.m_SubMesh->m_Indices };
+					  size_t target_triangles{ static_cast<size_t>(indices.size() / 3 * std::pow(Options.m_LodRatio, static_cast<float>(job.m_Level + 1))) };
+
+					  MeshSimplifier::Settings settings{ Options.m_LodMaxError * job.m_Radius, 0.5f, 0.5f };
+					  CompiledModel::Lod& lod{ job.m_SubMesh->m_Lods[job.m_Level] };
+					  lod.m_Indices = MeshSimplifier::Simplify(*job.m_SubMesh, target_triangles * 3, settings, lod.m_Error);
+				  });
+
+	//drop levels that stopped getting coarser once the error limit was reached
+	for (auto& sub_mesh : Mesh.GetSubMeshes())
+	{
+		size_t previous_count{ sub_mesh.m_Indices.size() };
+		size_t kept{};
+
+		for (auto& lod : sub_mesh.m_Lods)
+		{
+			if (lod.m_Indices.empty() || lod.m_Indices.size() >= previous_count)
+				continue;
+
+			previous_count = lod.m_Indices.size();
+			sub_mesh.m_Lods[kept++] = std::move(lod);
+		}
+
+		sub_mesh.m_Lods.resize(kept);
+	}
+}
+
+void MeshBuilder::ComputeBounds(CompiledModel& Mesh)
+{
+	auto& sub_meshes{ Mesh.GetSubMeshes() };
+
+	std::for_each(std::execution::par, sub_meshes.begin(), sub_meshes.end(),
+				  [](CompiledModel::SubMesh& sub_mesh)
+				  {
+					  sub_mesh.m_Bounds = BoundsBuilder::ComputeBounds(sub_mesh.m_Vertices);
+				  });
+
+	CompiledModel::Bounds bounds{ BoundsBuilder::Empty() };
+
+	for (const auto& sub_mesh : sub_meshes)
+	{
+		for (const auto& instance : sub_mesh.m_Instances)
+			bounds = BoundsBuilder::Merge(bounds, BoundsBuilder::Transform(sub_mesh.m_Bounds, instance.m_Transform));
+	}
+
+	Mesh.SetBounds(bounds);
+}
+
+void MeshBuilder::MergeSubMeshes(CompiledModel& Mesh, size_t MaxVertices)
+{
+	std::vector<CompiledModel::SubMesh> sub_meshes;
+	sub_meshes.swap(Mesh.GetSubMeshes());
+
+	std::vector<CompiledModel::SubMesh> merged;
+	std::unordered_map<std::string, size_t> open_groups;			//material and attributes to the submesh still taking parts
+
+	for (auto& sub_mesh : sub_meshes)
+	{
+		bool skinned{ (sub_mesh.m_Attributes & CompiledModel::Attribute_Skin) != 0 };
+
+		//rigidly animated parts keep their own node, instanced meshes stay instanced
+		if ((sub_mesh.m_NodeAnimated && !skinned) || sub_mesh.m_Instances.size() != 1)
+		{
+			merged.push_back(std::move(sub_mesh));
+			continue;
+		}
+
+		//skinned vertices are already in bind space, static ones get their node transform applied
+		if (!skinned)
+			BakeTransform(sub_mesh);
+
+		std::string key{ sub_mesh.m_Material.first + '#' + std::to_string(sub_mesh.m_Attributes) };
+		auto group{ open_groups.find(key) };
+
+		if (group == open_groups.end() || merged[group->second].m_Vertices.size() + sub_mesh.m_Vertices.size() > MaxVertices)
+		{
+			open_groups[key] = merged.size();
+			merged.push_back(CompiledModel::SubMesh{ {}, {}, sub_mesh.m_Material });
+			merged.back().m_Instances = sub_mesh.m_Instances;
+			merged.back().m_Attributes = sub_mesh.m_Attributes;
+			group = open_groups.find(key);
+		}
+
+		CompiledModel::SubMesh& target{ merged[group->second] };
+		GLuint base_vertex{ static_cast<GLuint>(target.m_Vertices.size()) };
+
+		target.m_Parts.push_back({ static_cast<std::uint32_t>(target.m_Indices.size()),
+								   static_cast<std::uint32_t>(sub_mesh.m_Indices.size()),
+								   BoundsBuilder::ComputeBounds(sub_mesh.m_Vertices) });
+
+		target.m_Vertices.insert(target.m_Vertices.end(), sub_mesh.m_Vertices.begin(), sub_mesh.m_Vertices.end());
+
+		for (GLuint index : sub_mesh.m_Indices)
+			target.m_Indices.push_back(base_vertex + index);
+	}
+
+	//a single part needs no range table
+	for (auto& sub_mesh : merged)
+	{
+		if (sub_mesh.m_Parts.size() == 1)
+			sub_mesh.m_Parts.clear();
+	}
+
+	Mesh.GetSubMeshes().swap(merged);
+}
+
+void MeshBuilder::BakeTransform(CompiledModel::SubMesh& SubMesh)
+{
+	glm::mat4 transform{ SubMesh.m_Instances.front().m_Transform };
+	glm::mat3 normal_transform{ glm::transpose(glm::inverse(glm::mat3{ transform })) };
+
+	for (auto& vertex : SubMesh.m_Vertices)
+	{
+		vertex.m_Position = glm::vec3{ transform * glm::vec4{ vertex.m_Position, 1.0f } };
+
+		if (SubMesh.m_Attributes & CompiledModel::Attribute_Normal)
+			vertex.m_Normal = glm::normalize(normal_transform * vertex.m_Normal);
+
+		if (SubMesh.m_Attributes & CompiledModel::Attribute_UV)
+		{
+			vertex.m_Tangent = glm::normalize(glm::mat3{ transform } * vertex.m_Tangent);
+			vertex.m_BiTangent = glm::normalize(glm::mat3{ transform } * vertex.m_BiTangent);
+		}
+	}
+
+	//mirroring transforms turn the triangles inside out
+	if (glm::determinant(glm::mat3{ transform }) < 0.0f)
+	{
+		for (size_t i = 0; i + 2 < SubMesh.m_Indices.size(); i += 3)
+			std::swap(SubMesh.m_Indices[i + 1], SubMesh.m_Indices[i + 2]);
+	}
+
+	SubMesh.m_Instances.front() = CompiledModel::NodeInstance{};
 }
\ No newline at end of file
@@ -13,9 +13,11 @@
 #define MESHBUILDER_H
 
 #include <string>
+#include <limits>
 #include "assimp/scene.h"
 
 #include "CompiledModel.h"
+#include "CompilerOptions.h"
 
 class MeshBuilder
 {
@@ -26,14 +28,33 @@ public:
 
 	MeshBuilder& operator=(const MeshBuilder&) = delete;
 
-	static CompiledModel Build3DMesh(const std::string& File);
+	static CompiledModel Build3DMesh(const std::string& File, const CompilerOptions& Options = {});
 
 private:
-	static CompiledModel::SubMesh ProcessSubMesh(aiMesh* SubMesh, const aiScene* Scene, CompiledModel& Mesh);
-	static void ProcessNode(aiNode* Node, const aiScene* Scene, CompiledModel& Mesh);
-	static void ExtractVertexBoneWeight(std::vector<CompiledModel::Vertex>& Vertices, aiMesh* SubMesh, CompiledModel& Mesh);
+	static CompiledModel::SubMesh ProcessSubMesh(aiMesh* SubMesh, const aiScene* Scene, CompiledModel& Mesh, const CompilerOptions& Options);
+	static void ProcessNode(aiNode* Node, const aiScene* Scene, CompiledModel& Mesh, const glm::mat4& ParentTransform, std::vector<size_t>& MeshToSubMesh, const CompilerOptions& Options);
+	static const aiNode* FindAnimatedNode(const aiNode* Node, const aiScene* Scene);
+	static glm::mat4 ToMat4(const aiMatrix4x4& Matrix);
+	static void ExtractVertexBoneWeight(std::vector<CompiledModel::Vertex>& Vertices, aiMesh* SubMesh, CompiledModel& Mesh, const CompilerOptions& Options);
+	static void CountInfluences(CompiledModel::SubMesh& SubMesh);
 	static void LoadAnimations(aiAnimation** animation, int num_animations, aiNode* root_node, CompiledModel* model);
+	static void SortBones(CompiledModel& Mesh, const aiNode* Root);
+	static void PruneHierarchy(CompiledModel& Mesh);
+	static std::vector<NodeData> PruneNode(NodeData& Node, const std::unordered_map<std::string, BoneInfo>& BoneInfoMap, Animation& Clip);
+	static void BuildSkeletonTables(CompiledModel& Mesh);
+	static void FlattenSkeleton(const NodeData& Node, std::int32_t Parent, const std::unordered_map<std::string, std::int32_t>& Tracks,
+								const std::unordered_map<std::string, BoneInfo>& BoneInfoMap, SkeletonTable& Skeleton);
 	static std::pair <std::string, CompiledModel::Material> LoadMaterial(const std::string& Material, aiMaterial* AiMat);
+	static void SplitLargeSubMeshes(CompiledModel& Mesh, size_t MaxVertices);
+	static std::vector<CompiledModel::SubMesh> SplitSubMesh(const CompiledModel::SubMesh& SubMesh, size_t MaxVertices, size_t MaxBones = std::numeric_limits<size_t>::max());
+	static void BuildBonePalettes(CompiledModel& Mesh, size_t MaxBones);
+	static void LocalizeBones(CompiledModel::SubMesh& SubMesh);
+	static void OptimizeVertexFetch(CompiledModel::SubMesh& SubMesh);
+	static void BuildShadowMesh(CompiledModel::SubMesh& SubMesh);
+	static void GenerateLods(CompiledModel& Mesh, const CompilerOptions& Options);
+	static void ComputeBounds(CompiledModel& Mesh);
+	static void MergeSubMeshes(CompiledModel& Mesh, size_t MaxVertices);
+	static void BakeTransform(CompiledModel::SubMesh& SubMesh);
 };
 
 #endif
\ No newline at end of file
@@ -4,6 +4,9 @@
 #include <iostream>
 #include <filesystem>
 #include <fstream>
+#include <algorithm>
+#include <limits>
+#include <cstring>
 #include "CompiledModel.h"
 #include "MeshBuilder.h"
 #include "glm/gtc/type_ptr.hpp"
@@ -12,6 +15,20 @@ class MeshCompiler
 {
 	MeshBuilder* m_pMeshBuilder;
 
+	//"NUI" file tag, followed by the format version. Bump s_NuiVersion whenever the layout changes
+	//so previously compiled files get rebuilt.
+	static constexpr std::uint32_t s_NuiMagic{ 0x0049554E };
+	static constexpr std::uint16_t s_NuiVersion{ 19 };
+
+	//Optional chunks follow the primitive type as a chunk count, then a tag, byte size and payload
+	//per chunk, so loaders can skip the ones they do not use.
+	enum class ChunkTag : std::uint32_t
+	{
+		Meshlets = 0x4C48534D,		//"MSHL"
+		ShadowMesh = 0x57444853,	//"SHDW"
+		AnimatedBounds = 0x444E4241	//"ABND"
+	};
+
 public:
 
 	MeshCompiler(MeshBuilder* mesh_builder) : m_pMeshBuilder{ mesh_builder }
@@ -44,9 +61,13 @@ public:
 					//compare date modified
 					auto obj_time = std::filesystem::last_write_time(fbx_path);
 					auto nui_time = std::filesystem::last_write_time(nui_path);
+					std::string options_path{ CompilerOptions::GetOptionsPath(fbx_path) };
+
+					if (std::filesystem::is_regular_file(options_path))
+						obj_time = (std::max)(obj_time, std::filesystem::last_write_time(options_path));
 
 					//is not latest version
-					if (nui_time < obj_time)
+					if (nui_time < obj_time || !IsCurrentVersion(nui_path))
 					{
 						//update file
 						std::cout << ".nui file for " << mesh_file_name << " is being updated." << std::endl;
@@ -153,23 +174,16 @@ public:
 		return sizeof(std::uint16_t) + size;
 	}
 
-	bool CheckIfAffectedByBone(std::vector<CompiledModel::SubMesh>& submeshes)
+	bool IsCurrentVersion(const std::string& nui_path)
 	{
-		for (auto& sub_mesh : submeshes)
-		{
-			for (auto& vert : sub_mesh.m_Vertices)
-			{
-				for (int i = 0; i < 4; ++i)
-				{
-					if (vert.m_BoneIDs[i] != -1)
-					{
-						return true;
-					}
-				}
-			}
-		}
+		std::ifstream ifs{ nui_path, std::ifstream::binary };
+		std::uint32_t magic{};
+		std::uint16_t version{};
+
+		ifs.read(reinterpret_cast<char*>(&magic), sizeof(std::uint32_t));
+		ifs.read(reinterpret_cast<char*>(&version), sizeof(std::uint16_t));
 
-		return false;
+		return ifs && magic == s_NuiMagic && version == s_NuiVersion;
 	}
 
 	void CompileMesh(std::string fbx_name, std::string nui_name)
@@ -177,37 +191,38 @@ public:
 		std::ofstream ofs;
 		ofs.open(nui_name, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
 
-		CompiledModel model{ m_pMeshBuilder->Build3DMesh(fbx_name) };
-
-		//ensure that animation moves for certain animations
-		if (model.GetAnimations().size())
-		{
-			if (!CheckIfAffectedByBone(model.GetSubMeshes()))
-			{
-				for (auto& sub_mesh : model.GetSubMeshes())
-				{
-					for (auto& vert : sub_mesh.m_Vertices)
-					{
-						vert.m_BoneIDs[0] = 0;
-						vert.m_Weights[0] = 1.0f;
-					}
-				}
-			}
-		}
+		CompilerOptions options{ CompilerOptions::Load(fbx_name) };
+		CompiledModel model{ m_pMeshBuilder->Build3DMesh(fbx_name, options) };
 
 		std::uint16_t num_submeshes { static_cast<std::uint16_t>(model.GetSubMeshes().size()) };
 		std::uint16_t num_bone_info { static_cast<std::uint16_t>(model.GetBoneInfoMap().size()) };
 		std::uint16_t num_animations { static_cast<std::uint16_t>(model.GetAnimations().size()) };
 		std::uint32_t total_offset{};
 
+		//File header
+		total_offset += WriteInfoToStream(s_NuiMagic, ofs);
+		total_offset += WriteInfoToStream(s_NuiVersion, ofs);
+
+		//Bounds header, readable before any vertex data
+		total_offset += WriteInfoToStream(model.GetBounds(), ofs);
+
 		//Submesh header
 		total_offset += WriteInfoToStream(num_submeshes, ofs);
 
 		for (auto& sub_mesh : model.GetSubMeshes())
 		{
-			total_offset += CompileSubmesh(sub_mesh, ofs);
+			total_offset += WriteInfoToStream(sub_mesh.m_Bounds, ofs);
+		}
+
+		for (auto& sub_mesh : model.GetSubMeshes())
+		{
+			total_offset += CompileSubmesh(sub_mesh, options, ofs);
 		}
 
+		//Instance table, every node drawing a submesh
+		std::vector<CompiledModel::Instance> instances{ GetInstances(model.GetSubMeshes(), model.GetBoneInfoMap()) };
+		total_offset += WriteInfoToStream(instances, ofs);
+
 		//Bone info header
 		total_offset += WriteInfoToStream(num_bone_info, ofs);
 
@@ -226,14 +241,68 @@ public:
 
 		int type{ model.GetPrimitive() };
 		WriteInfoToStream(type, ofs);
+
+		//Optional chunks
+		std::vector<std::pair<ChunkTag, std::stringstream>> chunks;
+
+		if (options.m_Meshlets)
+			CompileMeshlets(model.GetSubMeshes(), chunks.emplace_back(ChunkTag::Meshlets, std::stringstream{}).second);
+
+		if (!model.GetAnimatedBounds().empty())
+			CompileAnimatedBounds(model.GetAnimatedBounds(), chunks.emplace_back(ChunkTag::AnimatedBounds, std::stringstream{}).second);
+
+		if (options.m_ShadowMesh)
+			CompileShadowMeshes(model.GetSubMeshes(), options.m_GeometryCodec, chunks.emplace_back(ChunkTag::ShadowMesh, std::stringstream{}).second);
+
+		std::uint16_t num_chunks{ static_cast<std::uint16_t>(chunks.size()) };
+		WriteInfoToStream(num_chunks, ofs);
+
+		for (auto& [tag, payload] : chunks)
+		{
+			std::string data{ payload.str() };
+			std::uint32_t chunk_size{ static_cast<std::uint32_t>(data.size()) };
+
+			WriteInfoToStream(tag, ofs);
+			WriteInfoToStream(chunk_size, ofs);
+			ofs.write(data.data(), data.size());
+		}
 	}
 
-	std::uint32_t CompileSubmesh(CompiledModel::SubMesh& sub_mesh, std::ofstream& ofs)
+	std::uint32_t CompileSubmesh(CompiledModel::SubMesh& sub_mesh, const CompilerOptions& options, std::ofstream& ofs)
 	{
 		std::uint32_t size{};
-		
-		size += WriteInfoToStream(sub_mesh.m_Vertices, ofs);
-		size += WriteInfoToStream(sub_mesh.m_Indices, ofs);
+		GeometryCodec::Codec codec{ options.m_GeometryCodec };
+
+		size += WriteInfoToStream(codec, ofs);
+
+		if (options.m_SeparateStreams)
+		{
+			size += CompileVertexStreams(sub_mesh, codec, ofs);
+		}
+
+		else
+		{
+			std::uint8_t streams{};
+			size += WriteInfoToStream(streams, ofs);
+			size += CompileVertices(sub_mesh.m_Vertices, codec, ofs);
+		}
+
+		size += CompileIndices(sub_mesh.m_Indices, codec, ofs);
+		size += WriteInfoToStream(sub_mesh.m_MaxInfluences, ofs);
+		size += WriteInfoToStream(sub_mesh.m_BonePalette, ofs);
+
+		//LOD chain, sharing the vertices above
+		std::uint8_t num_lods{ static_cast<std::uint8_t>(sub_mesh.m_Lods.size()) };
+		size += WriteInfoToStream(num_lods, ofs);
+
+		for (auto& lod : sub_mesh.m_Lods)
+		{
+			size += WriteInfoToStream(lod.m_Error, ofs);
+			size += CompileIndices(lod.m_Indices, codec, ofs);
+		}
+
+		//Index ranges of merged source meshes
+		size += WriteInfoToStream(sub_mesh.m_Parts, ofs);
 
 		//Has material
 		if (sub_mesh.m_Material.first != "")
@@ -254,6 +323,213 @@ public:
 		return size;
 	}
 
+	//Raw streams are stored as is, compressed streams as the element count followed by the encoded bytes
+	template <typename T, typename Stream>
+	std::uint32_t CompileVertices(std::vector<T>& vertices, GeometryCodec::Codec codec, Stream& ofs)
+	{
+		if (codec == GeometryCodec::Codec::Raw)
+			return WriteInfoToStream(vertices, ofs);
+
+		std::uint32_t size{};
+		std::uint32_t vertex_count{ static_cast<std::uint32_t>(vertices.size()) };
+		std::vector<std::uint8_t> encoded{ GeometryCodec::EncodeVertexBuffer(vertices.data(), vertices.size(), sizeof(T)) };
+
+		size += WriteInfoToStream(vertex_count, ofs);
+		size += WriteInfoToStream(encoded, ofs);
+
+		return size;
+	}
+
+	//Stream mask, then one vertex array per stream in mask bit order. Streams for attributes the
+	//submesh does not provide are left out. A zero mask means interleaved CompiledModel::Vertex.
+	std::uint32_t CompileVertexStreams(CompiledModel::SubMesh& sub_mesh, GeometryCodec::Codec codec, std::ofstream& ofs)
+	{
+		std::uint32_t size{};
+		std::uint8_t streams{ CompiledModel::Stream_Position };
+
+		if (sub_mesh.m_Attributes & (CompiledModel::Attribute_Normal | CompiledModel::Attribute_UV))
+			streams |= CompiledModel::Stream_NormalFrame;
+
+		if (sub_mesh.m_Attributes & CompiledModel::Attribute_UV)
+			streams |= CompiledModel::Stream_UV;
+
+		if (sub_mesh.m_Attributes & CompiledModel::Attribute_Skin)
+			streams |= CompiledModel::Stream_Skin;
+
+		size += WriteInfoToStream(streams, ofs);
+
+		std::vector<glm::vec3> positions;
+		std::vector<CompiledModel::NormalFrame> normal_frames;
+		std::vector<glm::vec2> uvs;
+		std::vector<CompiledModel::SkinInfluence> skin;
+
+		for (auto& vertex : sub_mesh.m_Vertices)
+		{
+			positions.push_back(vertex.m_Position);
+
+			if (streams & CompiledModel::Stream_NormalFrame)
+				normal_frames.push_back({ vertex.m_Normal, vertex.m_Tangent, vertex.m_BiTangent });
+
+			if (streams & CompiledModel::Stream_UV)
+				uvs.push_back(vertex.m_UV);
+
+			if (streams & CompiledModel::Stream_Skin)
+				skin.push_back(GetSkinInfluence(vertex));
+		}
+
+		size += CompileVertices(positions, codec, ofs);
+
+		if (streams & CompiledModel::Stream_NormalFrame)
+			size += CompileVertices(normal_frames, codec, ofs);
+
+		if (streams & CompiledModel::Stream_UV)
+			size += CompileVertices(uvs, codec, ofs);
+
+		if (streams & CompiledModel::Stream_Skin)
+			size += CompileVertices(skin, codec, ofs);
+
+		return size;
+	}
+
+	std::vector<CompiledModel::Instance> GetInstances(std::vector<CompiledModel::SubMesh>& sub_meshes, std::unordered_map<std::string, BoneInfo>& bone_info_map)
+	{
+		std::vector<CompiledModel::Instance> instances;
+
+		for (size_t i = 0; i < sub_meshes.size(); ++i)
+		{
+			for (auto& node_instance : sub_meshes[i].m_Instances)
+			{
+				auto bone{ bone_info_map.find(node_instance.m_AnimatedNode) };
+
+				if (node_instance.m_AnimatedNode.empty() || bone == bone_info_map.end())
+				{
+					instances.push_back({ static_cast<std::uint32_t>(i), -1, node_instance.m_Transform });
+					continue;
+				}
+
+				//final bone matrices carry the bone offset, undo it so only the node's animated transform remains
+				instances.push_back({ static_cast<std::uint32_t>(i), bone->second.id,
+									  glm::inverse(bone->second.offset) * node_instance.m_NodeTransform });
+			}
+		}
+
+		return instances;
+	}
+
+	CompiledModel::SkinInfluence GetSkinInfluence(const CompiledModel::Vertex& vertex)
+	{
+		CompiledModel::SkinInfluence influence{};
+		std::memcpy(influence.m_BoneIDs, vertex.m_BoneIDs, sizeof(influence.m_BoneIDs));
+		std::memcpy(influence.m_Weights, vertex.m_Weights, sizeof(influence.m_Weights));
+
+		return influence;
+	}
+
+	//Stores indices with the narrowest width (1, 2 or 4 bytes) that can address every vertex
+	template <typename Stream>
+	std::uint32_t CompileIndices(std::vector<GLuint>& indices, GeometryCodec::Codec codec, Stream& ofs)
+	{
+		GLuint max_index{ indices.empty() ? 0 : *std::max_element(indices.begin(), indices.end()) };
+
+		if (max_index <= std::numeric_limits<std::uint8_t>::max())
+			return CompileIndices<std::uint8_t>(indices, codec, ofs);
+
+		if (max_index <= std::numeric_limits<std::uint16_t>::max())
+			return CompileIndices<std::uint16_t>(indices, codec, ofs);
+
+		return CompileIndices<std::uint32_t>(indices, codec, ofs);
+	}
+
+	template <typename T, typename Stream>
+	std::uint32_t CompileIndices(std::vector<GLuint>& indices, GeometryCodec::Codec codec, Stream& ofs)
+	{
+		std::uint32_t size{};
+		std::uint8_t index_width{ sizeof(T) };
+
+		size += WriteInfoToStream(index_width, ofs);
+
+		if (codec == GeometryCodec::Codec::Compressed)
+		{
+			std::uint32_t index_count{ static_cast<std::uint32_t>(indices.size()) };
+			std::vector<std::uint8_t> encoded{ GeometryCodec::EncodeIndexBuffer(indices.data(), indices.size()) };
+
+			size += WriteInfoToStream(index_count, ofs);
+			size += WriteInfoToStream(encoded, ofs);
+
+			return size;
+		}
+
+		std::vector<T> narrowed(indices.size());
+
+		for (size_t i = 0; i < indices.size(); ++i)
+			narrowed[i] = static_cast<T>(indices[i]);
+
+		size += WriteInfoToStream(narrowed, ofs);
+
+		return size;
+	}
+
+	//Meshlets of every submesh, in submesh order
+	void CompileMeshlets(std::vector<CompiledModel::SubMesh>& sub_meshes, std::stringstream& chunk)
+	{
+		for (auto& sub_mesh : sub_meshes)
+		{
+			WriteInfoToStream(sub_mesh.m_Meshlets, chunk);
+			WriteInfoToStream(sub_mesh.m_MeshletVertices, chunk);
+			WriteInfoToStream(sub_mesh.m_MeshletTriangles, chunk);
+		}
+	}
+
+	//Geometry codec, then per submesh in submesh order: stream mask (position, plus skin for skinned
+	//submeshes), the welded position / skin streams and the index buffer referencing them
+	void CompileShadowMeshes(std::vector<CompiledModel::SubMesh>& sub_meshes, GeometryCodec::Codec codec, std::stringstream& chunk)
+	{
+		WriteInfoToStream(codec, chunk);
+
+		for (auto& sub_mesh : sub_meshes)
+		{
+			std::uint8_t streams{ CompiledModel::Stream_Position };
+
+			if (sub_mesh.m_Attributes & CompiledModel::Attribute_Skin)
+				streams |= CompiledModel::Stream_Skin;
+
+			std::vector<glm::vec3> positions;
+			std::vector<CompiledModel::SkinInfluence> skin;
+
+			for (auto source : sub_mesh.m_ShadowVertices)
+			{
+				const auto& vertex{ sub_mesh.m_Vertices[source] };
+				positions.push_back(vertex.m_Position);
+
+				if (streams & CompiledModel::Stream_Skin)
+					skin.push_back(GetSkinInfluence(vertex));
+			}
+
+			WriteInfoToStream(streams, chunk);
+			CompileVertices(positions, codec, chunk);
+
+			if (streams & CompiledModel::Stream_Skin)
+				CompileVertices(skin, codec, chunk);
+
+			CompileIndices(sub_mesh.m_ShadowIndices, codec, chunk);
+		}
+	}
+
+	//Clip count, then per clip: name, whole clip bounds, per segment bounds and per bone bounds
+	void CompileAnimatedBounds(std::unordered_map<std::string, CompiledModel::AnimatedBounds>& animated_bounds, std::stringstream& chunk)
+	{
+		std::uint16_t num_clips{ static_cast<std::uint16_t>(animated_bounds.size()) };
+		WriteInfoToStream(num_clips, chunk);
+
+		for (auto& [name, bounds] : animated_bounds)
+		{
+			WriteInfoToStream(name, chunk);
+			WriteInfoToStream(bounds.m_Bounds, chunk);
+			WriteInfoToStream(bounds.m_Segments, chunk);
+			WriteInfoToStream(bounds.m_Bones, chunk);
+		}
+	}
+
 	std::uint16_t CompileBoneInfo(const std::pair<const std::string, BoneInfo>& bone, std::ofstream& ofs)
 	{
 		std::uint16_t size{};
@@ -274,6 +550,24 @@ public:
 		size += WriteInfoToStream(animation.second.GetDuration(), ofs);
 		size += WriteInfoToStream(animation.second.GetTicksPerSecond(), ofs);
 
+		//Bones with TrackEncoding::Soa keep their keys here, empty otherwise
+		SoaClip& soa_tracks{ animation.second.GetSoaTracks() };
+		size += WriteInfoToStream(soa_tracks.m_BoneCount, ofs);
+		size += WriteInfoToStream(soa_tracks.m_Stride, ofs);
+		size += WriteInfoToStream(soa_tracks.m_FrameCount, ofs);
+		size += WriteInfoToStream(soa_tracks.m_SampleRate, ofs);
+		size += WriteInfoToStream(soa_tracks.m_Samples, ofs);
+
+		//Flattened hierarchy bound to the bones above
+		SkeletonTable& skeleton{ animation.second.GetSkeleton() };
+		size += WriteInfoToStream(skeleton.m_Nodes, ofs);
+		size += WriteInfoToStream(skeleton.m_Offsets, ofs);
+
+		//Timestamps of bones with TrackEncoding::Timelines, empty otherwise
+		KeyTimelines& timelines{ animation.second.GetTimelines() };
+		size += WriteInfoToStream(timelines.m_Times, ofs);
+		size += WriteInfoToStream(timelines.m_Offsets, ofs);
+
 		//Bone header
 		std::uint16_t num_bones{ static_cast<std::uint16_t>(animation.second.GetBones().size()) };
 		size += WriteInfoToStream(num_bones, ofs);
@@ -310,9 +604,62 @@ public:
 	{
 		std::uint32_t size{};
 
-		size += WriteInfoToStream(bone.m_Positions, ofs);
-		size += WriteInfoToStream(bone.m_Rotations, ofs);
-		size += WriteInfoToStream(bone.m_Scales, ofs);
+		size += WriteInfoToStream(bone.m_Encoding, ofs);
+		size += WriteInfoToStream(bone.m_Nlerp, ofs);
+		size += WriteInfoToStream(bone.m_BindPosition, ofs);
+		size += WriteInfoToStream(bone.m_BindRotation, ofs);
+		size += WriteInfoToStream(bone.m_BindScale, ofs);
+
+		if (bone.m_Encoding == TrackEncoding::Quantized)
+		{
+			QuantizedTrack& track{ bone.m_Quantized };
+
+			size += WriteInfoToStream(track.m_FrameDuration, ofs);
+			size += WriteInfoToStream(track.m_PositionMin, ofs);
+			size += WriteInfoToStream(track.m_PositionExtent, ofs);
+			size += WriteInfoToStream(track.m_ScaleMin, ofs);
+			size += WriteInfoToStream(track.m_ScaleExtent, ofs);
+			size += WriteInfoToStream(track.m_Positions, ofs);
+			size += WriteInfoToStream(track.m_Rotations, ofs);
+			size += WriteInfoToStream(track.m_Scales, ofs);
+		}
+
+		else if (bone.m_Encoding == TrackEncoding::Uniform)
+		{
+			UniformTrack& track{ bone.m_Uniform };
+
+			size += WriteInfoToStream(track.m_SampleRate, ofs);
+			size += WriteInfoToStream(track.m_Positions, ofs);
+			size += WriteInfoToStream(track.m_Rotations, ofs);
+			size += WriteInfoToStream(track.m_Scales, ofs);
+		}
+
+		else if (bone.m_Encoding == TrackEncoding::Curves)
+		{
+			size += WriteInfoToStream(bone.m_Curves.m_Positions, ofs);
+			size += WriteInfoToStream(bone.m_Curves.m_Rotations, ofs);
+			size += WriteInfoToStream(bone.m_Curves.m_Scales, ofs);
+		}
+
+		else if (bone.m_Encoding == TrackEncoding::Timelines)
+		{
+			TimelineTrack& track{ bone.m_Timeline };
+
+			size += WriteInfoToStream(track.m_PositionTimeline, ofs);
+			size += WriteInfoToStream(track.m_RotationTimeline, ofs);
+			size += WriteInfoToStream(track.m_ScaleTimeline, ofs);
+			size += WriteInfoToStream(track.m_Positions, ofs);
+			size += WriteInfoToStream(track.m_Rotations, ofs);
+			size += WriteInfoToStream(track.m_Scales, ofs);
+		}
+
+		else if (bone.m_Encoding != TrackEncoding::Soa)
+		{
+			size += WriteInfoToStream(bone.m_Positions, ofs);
+			size += WriteInfoToStream(bone.m_Rotations, ofs);
+			size += WriteInfoToStream(bone.m_Scales, ofs);
+		}
+
 		size += WriteInfoToStream(bone.m_LocalTransform, ofs);
 		size += WriteInfoToStream(bone.m_Name, ofs);
 		size += WriteInfoToStream(bone.m_ID, ofs);
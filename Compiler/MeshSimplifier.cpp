@@ -0,0 +1,325 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+void MeshSimplifier::Quadric::AddPlane(const glm::dvec3& normal, double distance, double weight)
+{
+	m_A00 += weight * normal.x * normal.x;
+	m_A11 += weight * normal.y * normal.y;
+	m_A22 += weight * normal.z * normal.z;
+	m_A01 += weight * normal.x * normal.y;
+	m_A02 += weight * normal.x * normal.z;
+	m_A12 += weight * normal.y * normal.z;
+	m_B0 += weight * normal.x * distance;
+	m_B1 += weight * normal.y * distance;
+	m_B2 += weight * normal.z * distance;
+	m_C += weight * distance * distance;
+	m_Weight += weight;
+}
+
+double MeshSimplifier::Quadric::Evaluate(const glm::vec3& point) const
+{
+	double x{ point.x }, y{ point.y }, z{ point.z };
+
+	double error{ m_A00 * x * x + m_A11 * y * y + m_A22 * z * z +
+				  2 * (m_A01 * x * y + m_A02 * x * z + m_A12 * y * z) +
+				  2 * (m_B0 * x + m_B1 * y + m_B2 * z) + m_C };
+
+	return m_Weight > 0.0 ? (std::max)(error / m_Weight, 0.0) : 0.0;
+}
+
+MeshSimplifier::Quadric& MeshSimplifier::Quadric::operator+=(const Quadric& rhs)
+{
+	m_A00 += rhs.m_A00; m_A11 += rhs.m_A11; m_A22 += rhs.m_A22;
+	m_A01 += rhs.m_A01; m_A02 += rhs.m_A02; m_A12 += rhs.m_A12;
+	m_B0 += rhs.m_B0; m_B1 += rhs.m_B1; m_B2 += rhs.m_B2;
+	m_C += rhs.m_C;
+	m_Weight += rhs.m_Weight;
+
+	return *this;
+}
+
+float MeshSimplifier::SkinDistance(const CompiledModel::Vertex& Lhs, const CompiledModel::Vertex& Rhs)
+{
+	float distance{};
+
+	for (int i = 0; i < 4; ++i)
+	{
+		if (Lhs.m_BoneIDs[i] == -1)
+			continue;
+
+		float other{};
+
+		for (int j = 0; j < 4; ++j)
+		{
+			if (Rhs.m_BoneIDs[j] == Lhs.m_BoneIDs[i])
+				other = Rhs.m_Weights[j];
+		}
+
+		distance += std::abs(Lhs.m_Weights[i] - other);
+	}
+
+	//influences only present on the right hand side
+	for (int j = 0; j < 4; ++j)
+	{
+		if (Rhs.m_BoneIDs[j] == -1)
+			continue;
+
+		bool shared{ false };
+
+		for (int i = 0; i < 4; ++i)
+			shared |= Lhs.m_BoneIDs[i] == Rhs.m_BoneIDs[j];
+
+		if (!shared)
+			distance += Rhs.m_Weights[j];
+	}
+
+	return distance;
+}
+
+std::vector<GLuint> MeshSimplifier::Simplify(const CompiledModel::SubMesh& SubMesh, size_t TargetIndexCount, const Settings& Settings, float& Error)
+{
+	const std::vector<CompiledModel::Vertex>& vertices{ SubMesh.m_Vertices };
+	std::vector<GLuint> indices{ SubMesh.m_Indices };
+	size_t num_vertices{ vertices.size() };
+
+	Error = 0.0f;
+
+	if (indices.size() <= TargetIndexCount)
+		return indices;
+
+	//vertices sharing a position differ in UV / normal / tangent: they form a seam and stay locked,
+	//as do vertices on open or non-manifold edges
+	std::vector<GLuint> position_ids(num_vertices);
+	std::vector<std::uint32_t> position_counts(num_vertices, 0);
+	{
+		struct PositionHash
+		{
+			size_t operator()(const glm::vec3& position) const
+			{
+				std::uint32_t bits[3];
+				std::memcpy(bits, &position, sizeof(bits));
+				return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+			}
+		};
+
+		std::unordered_map<glm::vec3, GLuint, PositionHash> first_vertex;
+		first_vertex.reserve(num_vertices);
+
+		for (GLuint vertex = 0; vertex < num_vertices; ++vertex)
+		{
+			position_ids[vertex] = first_vertex.emplace(vertices[vertex].m_Position, vertex).first->second;
+			++position_counts[position_ids[vertex]];
+		}
+	}
+
+	std::vector<bool> locked(num_vertices, false);
+	{
+		std::unordered_map<std::uint64_t, int> edges;
+		edges.reserve(indices.size());
+
+		auto edge_key = [](GLuint from, GLuint to) { return static_cast<std::uint64_t>(from) << 32 | to; };
+
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (size_t corner = 0; corner < 3; ++corner)
+				++edges[edge_key(position_ids[indices[i + corner]], position_ids[indices[i + (corner + 1) % 3]])];
+		}
+
+		for (const auto& [key, count] : edges)
+		{
+			GLuint from{ static_cast<GLuint>(key >> 32) }, to{ static_cast<GLuint>(key & 0xFFFFFFFF) };
+			auto opposite{ edges.find(edge_key(to, from)) };
+
+			if (count != 1 || opposite == edges.end() || opposite->second != 1)
+			{
+				locked[from] = true;
+				locked[to] = true;
+			}
+		}
+
+		for (GLuint vertex = 0; vertex < num_vertices; ++vertex)
+			locked[vertex] = locked[position_ids[vertex]] || position_counts[position_ids[vertex]] > 1;
+	}
+
+	//area weighted plane quadrics, normalised by their total area so errors stay distances whatever the mesh scale
+	std::vector<Quadric> quadrics(num_vertices, Quadric{});
+
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		glm::dvec3 a{ vertices[indices[i]].m_Position }, b{ vertices[indices[i + 1]].m_Position }, c{ vertices[indices[i + 2]].m_Position };
+		glm::dvec3 normal{ glm::cross(b - a, c - a) };
+		double area{ glm::length(normal) };
+
+		if (area <= 0.0)
+			continue;
+
+		normal /= area;
+
+		for (size_t corner = 0; corner < 3; ++corner)
+			quadrics[indices[i + corner]].AddPlane(normal, -glm::dot(normal, a), area * 0.5);
+	}
+
+	double max_error{ static_cast<double>(Settings.m_MaxError) * Settings.m_MaxError };
+	double result_error{};
+	std::vector<GLuint> collapse_target(num_vertices);
+	std::vector<double> collapse_error(num_vertices);
+	std::vector<std::uint32_t> adjacency_offsets(num_vertices + 1);
+	std::vector<std::uint32_t> adjacency;
+	std::vector<bool> pass_locked(num_vertices);
+	std::vector<GLuint> order;
+
+	while (indices.size() > TargetIndexCount)
+	{
+		//vertex to triangle adjacency of the current triangles
+		std::fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0);
+
+		for (GLuint index : indices)
+			++adjacency_offsets[index + 1];
+
+		std::partial_sum(adjacency_offsets.begin(), adjacency_offsets.end(), adjacency_offsets.begin());
+		adjacency.resize(indices.size());
+
+		std::vector<std::uint32_t> fill{ adjacency_offsets.begin(), adjacency_offsets.end() - 1 };
+
+		for (size_t i = 0; i < indices.size(); ++i)
+			adjacency[fill[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+
+		//cheapest half edge collapse per unlocked vertex
+		std::fill(collapse_error.begin(), collapse_error.end(), std::numeric_limits<double>::max());
+
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				GLuint from{ indices[i + corner] }, to{ indices[i + (corner + 1) % 3] };
+
+				for (int direction = 0; direction < 2; ++direction, std::swap(from, to))
+				{
+					if (locked[from] || from == to)
+						continue;
+
+					Quadric quadric{ quadrics[from] };
+					quadric += quadrics[to];
+					double error{ quadric.Evaluate(vertices[to].m_Position) };
+
+					if (error < collapse_error[from])
+					{
+						collapse_error[from] = error;
+						collapse_target[from] = to;
+					}
+				}
+			}
+		}
+
+		order.clear();
+
+		for (GLuint vertex = 0; vertex < num_vertices; ++vertex)
+		{
+			if (collapse_error[vertex] <= max_error)
+				order.push_back(vertex);
+		}
+
+		std::sort(order.begin(), order.end(), [&](GLuint lhs, GLuint rhs) { return collapse_error[lhs] < collapse_error[rhs]; });
+		std::fill(pass_locked.begin(), pass_locked.end(), false);
+
+		size_t remaining_triangles{ indices.size() / 3 };
+		size_t collapses{};
+
+		for (GLuint from : order)
+		{
+			GLuint to{ collapse_target[from] };
+
+			if (pass_locked[from] || pass_locked[to])
+				continue;
+
+			if (glm::dot(vertices[from].m_Normal, vertices[to].m_Normal) < Settings.m_MinNormalDot ||
+				SkinDistance(vertices[from], vertices[to]) > Settings.m_MaxSkinDistance)
+				continue;
+
+			//reject collapses that flip a remaining triangle
+			bool flipped{ false };
+			size_t removed{};
+
+			for (std::uint32_t i = adjacency_offsets[from]; i < adjacency_offsets[from + 1] && !flipped; ++i)
+			{
+				const GLuint* triangle{ &indices[adjacency[i] * 3] };
+
+				if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+				{
+					++removed;
+					continue;
+				}
+
+				glm::vec3 before[3], after[3];
+
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					before[corner] = vertices[triangle[corner]].m_Position;
+					after[corner] = vertices[triangle[corner] == from ? to : triangle[corner]].m_Position;
+				}
+
+				glm::vec3 normal_before{ glm::cross(before[1] - before[0], before[2] - before[0]) };
+				glm::vec3 normal_after{ glm::cross(after[1] - after[0], after[2] - after[0]) };
+
+				flipped = glm::dot(normal_before, normal_after) <= 0.0f;
+			}
+
+			if (flipped)
+				continue;
+
+			//neighbours keep their positions for the rest of the pass so the flip checks above stay valid
+			for (std::uint32_t i = adjacency_offsets[from]; i < adjacency_offsets[from + 1]; ++i)
+			{
+				for (size_t corner = 0; corner < 3; ++corner)
+					pass_locked[indices[adjacency[i] * 3 + corner]] = true;
+			}
+
+			collapse_target[from] = to;
+			quadrics[to] += quadrics[from];
+			result_error = (std::max)(result_error, collapse_error[from]);
+			remaining_triangles -= removed;
+			++collapses;
+
+			//mark as applied, vertices without a collapse map onto themselves below
+			collapse_error[from] = -1.0;
+
+			if (remaining_triangles * 3 <= TargetIndexCount)
+				break;
+		}
+
+		if (!collapses)
+			break;
+
+		size_t write{};
+
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			GLuint triangle[3];
+
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				GLuint vertex{ indices[i + corner] };
+				triangle[corner] = collapse_error[vertex] < 0.0 ? collapse_target[vertex] : vertex;
+			}
+
+			if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2])
+				continue;
+
+			indices[write++] = triangle[0];
+			indices[write++] = triangle[1];
+			indices[write++] = triangle[2];
+		}
+
+		indices.resize(write);
+	}
+
+	Error = static_cast<float>(std::sqrt(result_error));
+
+	return indices;
+}
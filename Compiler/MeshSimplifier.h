@@ -0,0 +1,34 @@
+#pragma once
+#include "CompiledModel.h"
+
+//Quadric error edge collapse simplification. Vertices only ever collapse onto existing
+//vertices, so the simplified index buffers can share the submesh's vertex buffer.
+class MeshSimplifier
+{
+public:
+	struct Settings
+	{
+		float m_MaxError;				//object space distance a collapse may move the surface
+		float m_MaxSkinDistance;		//L1 distance between the bone weights of collapsed vertices
+		float m_MinNormalDot;			//cosine between the normals of collapsed vertices
+	};
+
+	//Returns the simplified triangle list, Error receives the largest surface deviation introduced
+	static std::vector<GLuint> Simplify(const CompiledModel::SubMesh& SubMesh, size_t TargetIndexCount, const Settings& Settings, float& Error);
+
+private:
+	struct Quadric
+	{
+		double m_A00, m_A11, m_A22, m_A01, m_A02, m_A12;
+		double m_B0, m_B1, m_B2;
+		double m_C;
+		double m_Weight;				//summed plane weights, Evaluate divides by it
+
+		void AddPlane(const glm::dvec3& normal, double distance, double weight);
+		//weighted mean squared distance of point to the planes, in object space units squared
+		double Evaluate(const glm::vec3& point) const;
+		Quadric& operator+=(const Quadric& rhs);
+	};
+
+	static float SkinDistance(const CompiledModel::Vertex& Lhs, const CompiledModel::Vertex& Rhs);
+};
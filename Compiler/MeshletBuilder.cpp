@@ -0,0 +1,240 @@
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+void MeshletBuilder::BuildMeshlets(CompiledModel::SubMesh& SubMesh, size_t MaxVertices, size_t MaxTriangles)
+{
+	MaxVertices = (std::min)(MaxVertices, size_t{ 256 });
+
+	size_t num_vertices{ SubMesh.m_Vertices.size() };
+	size_t num_triangles{ SubMesh.m_Indices.size() / 3 };
+	const std::vector<GLuint>& indices{ SubMesh.m_Indices };
+
+	SubMesh.m_Meshlets.clear();
+	SubMesh.m_MeshletVertices.clear();
+	SubMesh.m_MeshletTriangles.clear();
+
+	if (!num_triangles || MaxVertices < 3 || !MaxTriangles)
+		return;
+
+	//vertex to triangle adjacency
+	std::vector<std::uint32_t> adjacency_offsets(num_vertices + 1, 0);
+	std::vector<std::uint32_t> adjacency(num_triangles * 3);
+
+	for (GLuint index : indices)
+		++adjacency_offsets[index + 1];
+
+	for (size_t i = 0; i < num_vertices; ++i)
+		adjacency_offsets[i + 1] += adjacency_offsets[i];
+
+	std::vector<std::uint32_t> fill{ adjacency_offsets.begin(), adjacency_offsets.end() - 1 };
+
+	for (size_t i = 0; i < indices.size(); ++i)
+		adjacency[fill[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+
+	std::vector<glm::vec3> centroids(num_triangles);
+
+	for (size_t triangle = 0; triangle < num_triangles; ++triangle)
+	{
+		centroids[triangle] = (SubMesh.m_Vertices[indices[triangle * 3 + 0]].m_Position +
+							   SubMesh.m_Vertices[indices[triangle * 3 + 1]].m_Position +
+							   SubMesh.m_Vertices[indices[triangle * 3 + 2]].m_Position) / 3.0f;
+	}
+
+	constexpr std::uint32_t unused{ std::numeric_limits<std::uint32_t>::max() };
+	std::vector<std::uint32_t> local_ids(num_vertices, unused);
+	std::vector<std::uint32_t> candidate_stamp(num_triangles, unused);
+	std::vector<bool> emitted(num_triangles, false);
+	std::vector<std::uint32_t> candidates;
+	size_t num_emitted{};
+	size_t seed_scan{};
+
+	while (num_emitted < num_triangles)
+	{
+		std::uint32_t meshlet_id{ static_cast<std::uint32_t>(SubMesh.m_Meshlets.size()) };
+		CompiledModel::Meshlet meshlet{};
+		meshlet.m_VertexOffset = static_cast<std::uint32_t>(SubMesh.m_MeshletVertices.size());
+		meshlet.m_TriangleOffset = static_cast<std::uint32_t>(SubMesh.m_MeshletTriangles.size() / 3);
+		glm::vec3 centroid_sum{ 0.0f };
+
+		//continue next to the previous meshlet where possible, so neighbouring clusters stay compact
+		std::uint32_t seed{ unused };
+
+		for (std::uint32_t candidate : candidates)
+		{
+			if (!emitted[candidate])
+			{
+				seed = candidate;
+				break;
+			}
+		}
+
+		while (seed == unused)
+		{
+			if (!emitted[seed_scan])
+				seed = static_cast<std::uint32_t>(seed_scan);
+
+			++seed_scan;
+		}
+
+		candidates.clear();
+
+		auto add_triangle = [&](std::uint32_t triangle)
+		{
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				GLuint vertex{ indices[triangle * 3 + corner] };
+
+				if (local_ids[vertex] == unused)
+				{
+					local_ids[vertex] = meshlet.m_VertexCount++;
+					SubMesh.m_MeshletVertices.push_back(vertex);
+				}
+
+				SubMesh.m_MeshletTriangles.push_back(static_cast<std::uint8_t>(local_ids[vertex]));
+
+				for (std::uint32_t i = adjacency_offsets[vertex]; i < adjacency_offsets[vertex + 1]; ++i)
+				{
+					std::uint32_t neighbour{ adjacency[i] };
+
+					if (!emitted[neighbour] && candidate_stamp[neighbour] != meshlet_id)
+					{
+						candidate_stamp[neighbour] = meshlet_id;
+						candidates.push_back(neighbour);
+					}
+				}
+			}
+
+			emitted[triangle] = true;
+			centroid_sum += centroids[triangle];
+			++meshlet.m_TriangleCount;
+			++num_emitted;
+		};
+
+		add_triangle(seed);
+
+		while (meshlet.m_TriangleCount < MaxTriangles)
+		{
+			glm::vec3 centroid{ centroid_sum / static_cast<float>(meshlet.m_TriangleCount) };
+			std::uint32_t best{ unused };
+			float best_score{ std::numeric_limits<float>::max() };
+			size_t live{};
+
+			//prefer triangles adding the fewest new vertices, then the closest ones
+			for (std::uint32_t candidate : candidates)
+			{
+				if (emitted[candidate])
+					continue;
+
+				candidates[live++] = candidate;
+
+				std::uint32_t new_vertices{};
+
+				for (size_t corner = 0; corner < 3; ++corner)
+					new_vertices += local_ids[indices[candidate * 3 + corner]] == unused;
+
+				if (meshlet.m_VertexCount + new_vertices > MaxVertices)
+					continue;
+
+				glm::vec3 offset{ centroids[candidate] - centroid };
+				float score{ static_cast<float>(new_vertices) * 1e30f + glm::dot(offset, offset) };
+
+				if (score < best_score)
+				{
+					best_score = score;
+					best = candidate;
+				}
+			}
+
+			candidates.resize(live);
+
+			if (best == unused)
+				break;
+
+			add_triangle(best);
+		}
+
+		for (std::uint32_t i = 0; i < meshlet.m_VertexCount; ++i)
+			local_ids[SubMesh.m_MeshletVertices[meshlet.m_VertexOffset + i]] = unused;
+
+		ComputeBounds(SubMesh, meshlet);
+		SubMesh.m_Meshlets.push_back(meshlet);
+	}
+}
+
+void MeshletBuilder::ComputeBounds(const CompiledModel::SubMesh& SubMesh, CompiledModel::Meshlet& Meshlet)
+{
+	const GLuint* vertices{ &SubMesh.m_MeshletVertices[Meshlet.m_VertexOffset] };
+	const std::uint8_t* triangles{ &SubMesh.m_MeshletTriangles[Meshlet.m_TriangleOffset * 3] };
+
+	auto position = [&](std::uint8_t local_id) -> const glm::vec3&
+	{
+		return SubMesh.m_Vertices[vertices[local_id]].m_Position;
+	};
+
+	glm::vec3 min{ std::numeric_limits<float>::max() };
+	glm::vec3 max{ std::numeric_limits<float>::lowest() };
+
+	for (std::uint32_t i = 0; i < Meshlet.m_VertexCount; ++i)
+	{
+		min = glm::min(min, SubMesh.m_Vertices[vertices[i]].m_Position);
+		max = glm::max(max, SubMesh.m_Vertices[vertices[i]].m_Position);
+	}
+
+	Meshlet.m_Center = (min + max) * 0.5f;
+	Meshlet.m_Radius = 0.0f;
+
+	for (std::uint32_t i = 0; i < Meshlet.m_VertexCount; ++i)
+		Meshlet.m_Radius = (std::max)(Meshlet.m_Radius, glm::length(SubMesh.m_Vertices[vertices[i]].m_Position - Meshlet.m_Center));
+
+	//normal cone from the face normals, degenerate triangles ignored
+	std::vector<glm::vec3> normals;
+	std::vector<glm::vec3> corners;
+	glm::vec3 normal_sum{ 0.0f };
+
+	for (std::uint32_t triangle = 0; triangle < Meshlet.m_TriangleCount; ++triangle)
+	{
+		const glm::vec3& a{ position(triangles[triangle * 3 + 0]) };
+		glm::vec3 normal{ glm::cross(position(triangles[triangle * 3 + 1]) - a, position(triangles[triangle * 3 + 2]) - a) };
+		float area{ glm::length(normal) };
+
+		if (area <= 0.0f)
+			continue;
+
+		normals.push_back(normal / area);
+		corners.push_back(a);
+		normal_sum += normal / area;
+	}
+
+	Meshlet.m_ConeApex = Meshlet.m_Center;
+	Meshlet.m_ConeAxis = glm::vec3{ 0.0f, 0.0f, 1.0f };
+	Meshlet.m_ConeCutoff = 2.0f;
+
+	float axis_length{ glm::length(normal_sum) };
+
+	if (normals.empty() || axis_length <= 0.0f)
+		return;
+
+	glm::vec3 axis{ normal_sum / axis_length };
+	float min_dot{ 1.0f };
+
+	for (const auto& normal : normals)
+		min_dot = (std::min)(min_dot, glm::dot(axis, normal));
+
+	Meshlet.m_ConeAxis = axis;
+
+	//cones wider than ~90 degrees never cull anything
+	if (min_dot <= 0.1f)
+		return;
+
+	//move the apex back along the axis until every triangle plane is in front of it
+	float max_t{};
+
+	for (size_t i = 0; i < normals.size(); ++i)
+		max_t = (std::max)(max_t, glm::dot(Meshlet.m_Center - corners[i], normals[i]) / glm::dot(axis, normals[i]));
+
+	Meshlet.m_ConeApex = Meshlet.m_Center - axis * max_t;
+	Meshlet.m_ConeCutoff = std::sqrt(1.0f - min_dot * min_dot);
+}
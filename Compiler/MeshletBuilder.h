@@ -0,0 +1,14 @@
+#pragma once
+#include "CompiledModel.h"
+
+//Partitions a submesh into meshlets (small vertex / triangle clusters with local index lists)
+//and computes the bounding sphere and normal cone of each for cluster culling.
+class MeshletBuilder
+{
+public:
+	//MaxVertices is clamped to 256 (local ids are 8-bit)
+	static void BuildMeshlets(CompiledModel::SubMesh& SubMesh, size_t MaxVertices, size_t MaxTriangles);
+
+private:
+	static void ComputeBounds(const CompiledModel::SubMesh& SubMesh, CompiledModel::Meshlet& Meshlet);
+};
@@ -1,56 +1,208 @@
 #include "NUILoader.h"
 #include "../RenderResource/RenderResourceManager.h"
 #include <queue>
+#include <cstring>
+#include <iterator>
 
 Model NUILoader::LoadNui(std::string file_path)
 {
 	Model model;
 	std::ifstream ifs{ file_path, std::ifstream::binary };
 
-	if (ifs)
+	//Read File header
+	std::uint32_t magic{};
+	std::uint16_t version{};
+	ifs.read(reinterpret_cast<char*>(&magic), sizeof(std::uint32_t));
+	ifs.read(reinterpret_cast<char*>(&version), sizeof(std::uint16_t));
+
+	//the rest of a file from another format or version has an unknown layout
+	if (!ifs || magic != s_NuiMagic || version != s_NuiVersion)
+		return model;
+
+	//Read Bounds header
+	Model::Bounds bounds{};
+	ifs.read(reinterpret_cast<char*>(&bounds), sizeof(Model::Bounds));
+	model.SetBounds(bounds);
+
+	//Read SubMesh header
+	std::uint16_t num_submeshes{};
+	ifs.read(reinterpret_cast<char*>(&num_submeshes), sizeof(std::uint16_t));
+
+	std::vector<Model::Bounds> sub_mesh_bounds(num_submeshes);
+
+	if (num_submeshes) { ifs.read(reinterpret_cast<char*>(&sub_mesh_bounds[0]), sizeof(Model::Bounds) * num_submeshes); }
+
+	for (std::uint16_t i = 0; i < num_submeshes ; ++i)
 	{
-		//Read SubMesh header
-		std::uint16_t num_submeshes{};
-		ifs.read(reinterpret_cast<char*>(&num_submeshes), sizeof(std::uint16_t));
+		model.AddSubMesh(LoadCompiledSubMesh(ifs));
+		model.GetSubMeshes().back().m_Bounds = sub_mesh_bounds[i];
+	}
 
-		for (std::uint16_t i = 0; i < num_submeshes ; ++i)
-		{
-			model.AddSubMesh(LoadCompiledSubMesh(ifs));
-		}
+	//Read Instance table
+	LoadVector(model.GetInstances(), ifs);
 
-		//Read BoneInfo header
-		std::uint16_t num_bone_info{};
-		ifs.read(reinterpret_cast<char*>(&num_bone_info), sizeof(std::uint16_t));
+	//Read BoneInfo header
+	std::uint16_t num_bone_info{};
+	ifs.read(reinterpret_cast<char*>(&num_bone_info), sizeof(std::uint16_t));
 
-		for (std::uint16_t i = 0; i < num_bone_info; ++i)
-		{
-			LoadCompiledBoneInfo(ifs, model.GetBoneInfoMap());
-		}
+	for (std::uint16_t i = 0; i < num_bone_info; ++i)
+	{
+		LoadCompiledBoneInfo(ifs, model.GetBoneInfoMap());
+	}
 
-		//Read Animation header
-		std::uint16_t num_animations{};
-		ifs.read(reinterpret_cast<char*>(&num_animations), sizeof(std::uint16_t));
+	//Read Animation header
+	std::uint16_t num_animations{};
+	ifs.read(reinterpret_cast<char*>(&num_animations), sizeof(std::uint16_t));
 
-		for (std::uint16_t i = 0; i < num_animations; ++i)
-		{
-			model.GetAnimations().insert(LoadCompiledAnimation(ifs));
-		}
+	for (std::uint16_t i = 0; i < num_animations; ++i)
+	{
+		model.GetAnimations().insert(LoadCompiledAnimation(ifs));
 	}
 
 	int type;
 	ifs.read(reinterpret_cast<char*>(&type), sizeof(int));
 	model.SetPrimitive(type);
+
+	//Read optional chunks
+	std::uint16_t num_chunks{};
+	ifs.read(reinterpret_cast<char*>(&num_chunks), sizeof(std::uint16_t));
+
+	for (std::uint16_t i = 0; ifs && i < num_chunks; ++i)
+	{
+		std::uint32_t tag{};
+		std::uint32_t chunk_size{};
+		ifs.read(reinterpret_cast<char*>(&tag), sizeof(std::uint32_t));
+		ifs.read(reinterpret_cast<char*>(&chunk_size), sizeof(std::uint32_t));
+
+		std::streampos chunk_end{ ifs.tellg() + static_cast<std::streamoff>(chunk_size) };
+
+		switch (tag)
+		{
+		case s_MeshletChunk:
+			LoadCompiledMeshlets(ifs, model);
+			break;
+		case s_ShadowMeshChunk:
+			LoadCompiledShadowMeshes(ifs, model);
+			break;
+		case s_AnimatedBoundsChunk:
+			LoadCompiledAnimatedBounds(ifs, model);
+			break;
+		default:
+			break;
+		}
+
+		ifs.seekg(chunk_end);
+	}
+
 	return model;
 }
 
+void NUILoader::LoadCompiledMeshlets(std::ifstream& ifs, Model& model)
+{
+	for (auto& sub_mesh : model.GetSubMeshes())
+	{
+		LoadVector(sub_mesh.m_Meshlets, ifs);
+		LoadVector(sub_mesh.m_MeshletVertices, ifs);
+		LoadVector(sub_mesh.m_MeshletTriangles, ifs);
+	}
+}
+
+void NUILoader::LoadCompiledShadowMeshes(std::ifstream& ifs, Model& model)
+{
+	GeometryCodec::Codec codec{};
+	ifs.read(reinterpret_cast<char*>(&codec), sizeof(GeometryCodec::Codec));
+
+	for (auto& sub_mesh : model.GetSubMeshes())
+	{
+		std::vector<std::byte> stream_data{};
+		GLintptr stream_offsets[4]{};
+		std::vector<glm::vec3> positions{};
+		std::vector<std::byte> indices{};
+		std::uint8_t index_width{};
+		std::uint8_t streams{};
+
+		ifs.read(reinterpret_cast<char*>(&streams), sizeof(std::uint8_t));
+		bool decoded{ LoadVertexStreams(stream_data, stream_offsets, positions, streams, codec, ifs) };
+		ifs.read(reinterpret_cast<char*>(&index_width), sizeof(std::uint8_t));
+		decoded &= LoadIndices(indices, index_width, codec, ifs);
+
+		//a shadow mesh that does not decode stays empty, without buffers
+		if (!ifs || !decoded)
+			continue;
+
+		auto& shadow_mesh{ sub_mesh.m_ShadowMesh };
+		shadow_mesh.m_VBO = CreateVertexBuffer(stream_data);
+		shadow_mesh.m_EBO = CreateIndexBuffer(indices);
+		shadow_mesh.m_Count = static_cast<GLuint>(indices.size() / index_width);
+		shadow_mesh.m_IndexType = GetIndexType(index_width);
+		shadow_mesh.m_Streams = streams;
+		shadow_mesh.m_SkinOffset = stream_offsets[3];
+	}
+}
+
+void NUILoader::LoadCompiledAnimatedBounds(std::ifstream& ifs, Model& model)
+{
+	std::uint16_t num_clips{};
+	ifs.read(reinterpret_cast<char*>(&num_clips), sizeof(std::uint16_t));
+
+	for (std::uint16_t i = 0; i < num_clips; ++i)
+	{
+		std::string clip_name;
+		LoadString(clip_name, ifs);
+
+		auto& bounds{ model.GetAnimatedBounds()[clip_name] };
+		ifs.read(reinterpret_cast<char*>(&bounds.m_Bounds), sizeof(Model::Bounds));
+		LoadVector(bounds.m_Segments, ifs);
+		LoadVector(bounds.m_Bones, ifs);
+	}
+}
+
 Model::SubMesh NUILoader::LoadCompiledSubMesh(std::ifstream& ifs)
 {
 	std::vector<Model::Vertex> vertices{};
-	std::vector<GLushort> indices{};
+	std::vector<std::byte> stream_data{};
+	GLintptr stream_offsets[4]{};
+	std::vector<glm::vec3> positions{};
+	std::vector<std::byte> indices{};
+	std::uint8_t index_width{};
+	std::uint8_t streams{};
+
+	GeometryCodec::Codec codec{};
 
 	std::pair<std::string, TempMaterial> material;
-	LoadVector(vertices, ifs);
-	LoadVector(indices, ifs);
+	ifs.read(reinterpret_cast<char*>(&codec), sizeof(GeometryCodec::Codec));
+	ifs.read(reinterpret_cast<char*>(&streams), sizeof(std::uint8_t));
+
+	//streams == 0 means interleaved Vertex data
+	bool decoded{ streams ? LoadVertexStreams(stream_data, stream_offsets, positions, streams, codec, ifs)
+						  : LoadGeometry(vertices, codec, ifs) };
+
+	ifs.read(reinterpret_cast<char*>(&index_width), sizeof(std::uint8_t));
+	decoded &= LoadIndices(indices, index_width, codec, ifs);
+
+	std::uint8_t max_influences{};
+	ifs.read(reinterpret_cast<char*>(&max_influences), sizeof(std::uint8_t));
+
+	std::vector<int> bone_palette{};
+	LoadVector(bone_palette, ifs);
+
+	std::uint8_t num_lods{};
+	ifs.read(reinterpret_cast<char*>(&num_lods), sizeof(std::uint8_t));
+
+	std::vector<Model::Lod> lods(num_lods);
+	std::vector<std::vector<std::byte>> lod_indices(num_lods);
+	std::vector<std::uint8_t> lod_index_widths(num_lods);
+
+	for (std::uint8_t i = 0; i < num_lods; ++i)
+	{
+		ifs.read(reinterpret_cast<char*>(&lods[i].m_Error), sizeof(float));
+		ifs.read(reinterpret_cast<char*>(&lod_index_widths[i]), sizeof(std::uint8_t));
+		decoded &= LoadIndices(lod_indices[i], lod_index_widths[i], codec, ifs);
+	}
+
+	std::vector<Model::Part> parts{};
+	LoadVector(parts, ifs);
+
 	LoadString(material.first, ifs);
 	LoadString(material.second.m_Ambient.first, ifs);
 	LoadString(material.second.m_Ambient.second, ifs);
@@ -61,7 +213,32 @@ Model::SubMesh NUILoader::LoadCompiledSubMesh(std::ifstream& ifs)
 	LoadString(material.second.m_Specular.first, ifs);
 	LoadString(material.second.m_Specular.second, ifs);
 
-	return CreateSubMesh(vertices, indices, material);
+	//truncated or corrupt geometry fails the submesh: it is kept so later per submesh data stays in step, but gets no buffers and draws nothing
+	if (!ifs || !decoded)
+	{
+		return Model::SubMesh{ {}, {}, 0, 0, 0, material.first, GetIndexType(index_width) };
+	}
+
+	for (std::uint8_t i = 0; i < num_lods; ++i)
+	{
+		lods[i].m_EBO = CreateIndexBuffer(lod_indices[i]);
+		lods[i].m_Count = static_cast<GLuint>(lod_indices[i].size() / lod_index_widths[i]);
+		lods[i].m_IndexType = GetIndexType(lod_index_widths[i]);
+	}
+
+	GLuint vbo{ streams ? CreateVertexBuffer(stream_data) : CreateVertexBuffer(vertices) };
+
+	Model::SubMesh sub_mesh{ CreateSubMesh(vertices, vbo, indices, index_width, material) };
+	sub_mesh.m_Lods = std::move(lods);
+	sub_mesh.m_Parts = std::move(parts);
+	sub_mesh.m_Streams = streams;
+	//separate streams leave the vertices empty, the positions stay on the CPU for picking and bounds
+	sub_mesh.m_Positions = std::move(positions);
+	sub_mesh.m_MaxInfluences = max_influences;
+	sub_mesh.m_BonePalette = std::move(bone_palette);
+	std::copy(std::begin(stream_offsets), std::end(stream_offsets), std::begin(sub_mesh.m_StreamOffsets));
+
+	return sub_mesh;
 }
 
 void NUILoader::LoadCompiledBoneInfo(std::ifstream& ifs, std::unordered_map<std::string, BoneInfo>& map)
@@ -88,6 +265,21 @@ std::pair<std::string, Animation> NUILoader::LoadCompiledAnimation(std::ifstream
 	float ticks;
 	ifs.read(reinterpret_cast<char*>(&ticks), sizeof(float));
 
+	SoaClip soa_tracks;
+	ifs.read(reinterpret_cast<char*>(&soa_tracks.m_BoneCount), sizeof(std::uint32_t));
+	ifs.read(reinterpret_cast<char*>(&soa_tracks.m_Stride), sizeof(std::uint32_t));
+	ifs.read(reinterpret_cast<char*>(&soa_tracks.m_FrameCount), sizeof(std::uint32_t));
+	ifs.read(reinterpret_cast<char*>(&soa_tracks.m_SampleRate), sizeof(float));
+	LoadVector(soa_tracks.m_Samples, ifs);
+
+	SkeletonTable skeleton;
+	LoadVector(skeleton.m_Nodes, ifs);
+	LoadVector(skeleton.m_Offsets, ifs);
+
+	KeyTimelines timelines;
+	LoadVector(timelines.m_Times, ifs);
+	LoadVector(timelines.m_Offsets, ifs);
+
 	//Bone header
 	std::uint16_t num_bones;
 	ifs.read(reinterpret_cast<char*>(&num_bones), sizeof(std::uint16_t));
@@ -119,7 +311,12 @@ std::pair<std::string, Animation> NUILoader::LoadCompiledAnimation(std::ifstream
 		LoadCompiledBoneInfo(ifs, bone_id_map);
 	}
 
-	return { animation_name, {duration, ticks, bones, root_node, bone_id_map} };
+	Animation animation{ duration, ticks, bones, root_node, bone_id_map };
+	animation.SetSoaTracks(std::move(soa_tracks));
+	animation.SetSkeleton(std::move(skeleton));
+	animation.SetTimelines(std::move(timelines));
+
+	return { animation_name, animation };
 }
 
 Bone NUILoader::LoadCompiledBone(std::ifstream& ifs)
@@ -127,18 +324,95 @@ Bone NUILoader::LoadCompiledBone(std::ifstream& ifs)
 	std::vector<KeyPosition> positions {};
 	std::vector<KeyRotation> rotations {};
 	std::vector<KeyScale> scales {};
+	QuantizedTrack quantized {};
+	UniformTrack uniform {};
+	CurveTrack curves {};
+	TimelineTrack timeline {};
+	TrackEncoding encoding;
+	bool nlerp;
+	glm::vec3 bind_position;
+	glm::quat bind_rotation;
+	glm::vec3 bind_scale;
 	glm::mat4 local_transform;
 	std::string name;
 	int id;
 
-	LoadVector(positions, ifs);
-	LoadVector(rotations, ifs);
-	LoadVector(scales, ifs);
+	ifs.read(reinterpret_cast<char*>(&encoding), sizeof(TrackEncoding));
+	ifs.read(reinterpret_cast<char*>(&nlerp), sizeof(bool));
+	ifs.read(reinterpret_cast<char*>(&bind_position), sizeof(glm::vec3));
+	ifs.read(reinterpret_cast<char*>(&bind_rotation), sizeof(glm::quat));
+	ifs.read(reinterpret_cast<char*>(&bind_scale), sizeof(glm::vec3));
+
+	if (encoding == TrackEncoding::Quantized)
+	{
+		ifs.read(reinterpret_cast<char*>(&quantized.m_FrameDuration), sizeof(float));
+		ifs.read(reinterpret_cast<char*>(&quantized.m_PositionMin), sizeof(glm::vec3));
+		ifs.read(reinterpret_cast<char*>(&quantized.m_PositionExtent), sizeof(glm::vec3));
+		ifs.read(reinterpret_cast<char*>(&quantized.m_ScaleMin), sizeof(glm::vec3));
+		ifs.read(reinterpret_cast<char*>(&quantized.m_ScaleExtent), sizeof(glm::vec3));
+		LoadVector(quantized.m_Positions, ifs);
+		LoadVector(quantized.m_Rotations, ifs);
+		LoadVector(quantized.m_Scales, ifs);
+	}
+
+	else if (encoding == TrackEncoding::Uniform)
+	{
+		ifs.read(reinterpret_cast<char*>(&uniform.m_SampleRate), sizeof(float));
+		LoadVector(uniform.m_Positions, ifs);
+		LoadVector(uniform.m_Rotations, ifs);
+		LoadVector(uniform.m_Scales, ifs);
+	}
+
+	else if (encoding == TrackEncoding::Curves)
+	{
+		LoadVector(curves.m_Positions, ifs);
+		LoadVector(curves.m_Rotations, ifs);
+		LoadVector(curves.m_Scales, ifs);
+	}
+
+	else if (encoding == TrackEncoding::Timelines)
+	{
+		ifs.read(reinterpret_cast<char*>(&timeline.m_PositionTimeline), sizeof(std::uint32_t));
+		ifs.read(reinterpret_cast<char*>(&timeline.m_RotationTimeline), sizeof(std::uint32_t));
+		ifs.read(reinterpret_cast<char*>(&timeline.m_ScaleTimeline), sizeof(std::uint32_t));
+		LoadVector(timeline.m_Positions, ifs);
+		LoadVector(timeline.m_Rotations, ifs);
+		LoadVector(timeline.m_Scales, ifs);
+	}
+
+	else if (encoding != TrackEncoding::Soa)
+	{
+		LoadVector(positions, ifs);
+		LoadVector(rotations, ifs);
+		LoadVector(scales, ifs);
+	}
+
 	ifs.read(reinterpret_cast<char*>(&local_transform), sizeof(glm::mat4));
 	LoadString(name, ifs);
 	ifs.read(reinterpret_cast<char*>(&id), sizeof(int));
 
-	return { positions, rotations, scales, local_transform, name, id };
+	Bone bone{ positions, rotations, scales, local_transform, name, id };
+
+	if (encoding == TrackEncoding::Quantized)
+		bone = { std::move(quantized), local_transform, name, id };
+
+	else if (encoding == TrackEncoding::Uniform)
+		bone = { std::move(uniform), local_transform, name, id };
+
+	else if (encoding == TrackEncoding::Curves)
+		bone = { std::move(curves), local_transform, name, id };
+
+	else if (encoding == TrackEncoding::Timelines)
+		bone.m_Timeline = std::move(timeline);
+
+	//Soa bones have no keys of their own, timeline bones keep theirs next to the clip's timestamps
+	bone.m_Encoding = encoding;
+	bone.m_Nlerp = nlerp;
+	bone.m_BindPosition = bind_position;
+	bone.m_BindRotation = bind_rotation;
+	bone.m_BindScale = bind_scale;
+
+	return bone;
 }
 
 void NUILoader::LoadCompiledNodeData(NodeData& node_data, std::ifstream& ifs, std::uint32_t offset)
@@ -178,6 +452,101 @@ void NUILoader::LoadVector(std::vector<T>& vec, std::ifstream& ifs)
 	if (vec_size) { ifs.read(reinterpret_cast<char*>(&vec[0]), vec_size); }
 }
 
+//false when compressed data does not decode, vec is then left empty
+template <typename T>
+bool NUILoader::LoadGeometry(std::vector<T>& vec, GeometryCodec::Codec codec, std::ifstream& ifs)
+{
+	if (codec == GeometryCodec::Codec::Raw)
+	{
+		LoadVector(vec, ifs);
+		return true;
+	}
+
+	std::uint32_t count{};
+	std::vector<std::uint8_t> encoded{};
+	ifs.read(reinterpret_cast<char*>(&count), sizeof(std::uint32_t));
+	LoadVector(encoded, ifs);
+
+	vec.resize(count);
+
+	if (!ifs || !GeometryCodec::DecodeVertexBuffer(vec.data(), count, sizeof(T), encoded.data(), encoded.size()))
+	{
+		vec.clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool NUILoader::LoadVertexStreams(std::vector<std::byte>& stream_data, GLintptr (&stream_offsets)[4], std::vector<glm::vec3>& positions, std::uint8_t streams, GeometryCodec::Codec codec, std::ifstream& ifs)
+{
+	bool decoded{ true };
+	std::vector<CompiledModel::NormalFrame> normal_frames{};
+	std::vector<glm::vec2> uvs{};
+	std::vector<CompiledModel::SkinInfluence> skin{};
+
+	//streams are stored in mask bit order, all of them go into one buffer. Every stream is read
+	//even after a failure so the file position stays in step
+	if (streams & CompiledModel::Stream_Position)
+		decoded &= AppendStream(stream_data, stream_offsets[0], positions, codec, ifs);
+
+	if (streams & CompiledModel::Stream_NormalFrame)
+		decoded &= AppendStream(stream_data, stream_offsets[1], normal_frames, codec, ifs);
+
+	if (streams & CompiledModel::Stream_UV)
+		decoded &= AppendStream(stream_data, stream_offsets[2], uvs, codec, ifs);
+
+	if (streams & CompiledModel::Stream_Skin)
+		decoded &= AppendStream(stream_data, stream_offsets[3], skin, codec, ifs);
+
+	if (!decoded)
+		positions.clear();
+
+	return decoded;
+}
+
+//stream keeps the decoded values for the caller, stream_data gets a copy at the next aligned offset
+template <typename T>
+bool NUILoader::AppendStream(std::vector<std::byte>& stream_data, GLintptr& stream_offset, std::vector<T>& stream, GeometryCodec::Codec codec, std::ifstream& ifs)
+{
+	if (!LoadGeometry(stream, codec, ifs))
+		return false;
+
+	size_t offset{ (stream_data.size() + s_StreamAlignment - 1) / s_StreamAlignment * s_StreamAlignment };
+	stream_data.resize(offset + sizeof(T) * stream.size());
+
+	if (!stream.empty()) { std::memcpy(&stream_data[offset], stream.data(), sizeof(T) * stream.size()); }
+
+	stream_offset = static_cast<GLintptr>(offset);
+
+	return true;
+}
+
+//false when compressed data does not decode, indices is then left empty
+bool NUILoader::LoadIndices(std::vector<std::byte>& indices, std::uint8_t index_width, GeometryCodec::Codec codec, std::ifstream& ifs)
+{
+	if (codec == GeometryCodec::Codec::Raw)
+	{
+		LoadVector(indices, ifs);
+		return true;
+	}
+
+	std::uint32_t count{};
+	std::vector<std::uint8_t> encoded{};
+	ifs.read(reinterpret_cast<char*>(&count), sizeof(std::uint32_t));
+	LoadVector(encoded, ifs);
+
+	indices.resize(count * index_width);
+
+	if (!ifs || !GeometryCodec::DecodeIndexBuffer(indices.data(), count, index_width, encoded.data(), encoded.size()))
+	{
+		indices.clear();
+		return false;
+	}
+
+	return true;
+}
+
 std::uint16_t NUILoader::LoadString(std::string& str, std::ifstream& ifs)
 {
 	std::uint16_t string_length{};
@@ -192,17 +561,36 @@ std::uint16_t NUILoader::LoadString(std::string& str, std::ifstream& ifs)
 	return sizeof(std::uint16_t) + sizeof(char) * string_length;
 }
 
-Model::SubMesh NUILoader::CreateSubMesh(std::vector<Model::Vertex>& vertices, std::vector<GLushort>& indices, std::pair<std::string, TempMaterial>& material)
+Model::SubMesh NUILoader::CreateSubMesh(std::vector<Model::Vertex>& vertices, GLuint vbo, std::vector<std::byte>& indices, std::uint8_t index_width, std::pair<std::string, TempMaterial>& material)
+{
+	GLuint ebo{ CreateIndexBuffer(indices) };
+
+	RenderResourceManager::GetInstanced().LoadMaterialNUI(material.first, material.second);
+
+	return std::move(Model::SubMesh{ vertices, indices, vbo, ebo, static_cast<GLuint>(indices.size() / index_width), material.first, GetIndexType(index_width) });
+}
+
+template <typename T>
+GLuint NUILoader::CreateVertexBuffer(std::vector<T>& vertex_data)
 {
 	GLuint vbo;
 	glCreateBuffers(1, &vbo);
-	glNamedBufferStorage(vbo, sizeof(Model::Vertex) * vertices.size(), vertices.data(), GL_DYNAMIC_STORAGE_BIT);
+	glNamedBufferStorage(vbo, sizeof(T) * vertex_data.size(), vertex_data.data(), GL_DYNAMIC_STORAGE_BIT);
+
+	return vbo;
+}
 
+GLuint NUILoader::CreateIndexBuffer(std::vector<std::byte>& indices)
+{
 	GLuint ebo;
 	glCreateBuffers(1, &ebo);
-	glNamedBufferStorage(ebo, sizeof(GLushort) * indices.size(), reinterpret_cast<GLvoid*>(indices.data()), GL_DYNAMIC_STORAGE_BIT);
+	glNamedBufferStorage(ebo, indices.size(), reinterpret_cast<GLvoid*>(indices.data()), GL_DYNAMIC_STORAGE_BIT);
 
-	RenderResourceManager::GetInstanced().LoadMaterialNUI(material.first, material.second);
+	return ebo;
+}
 
-	return std::move(Model::SubMesh{ vertices, indices, vbo, ebo, static_cast<GLuint>(indices.size()), material.first });
+GLenum NUILoader::GetIndexType(std::uint8_t index_width)
+{
+	return index_width == sizeof(GLubyte) ? GL_UNSIGNED_BYTE :
+		   index_width == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
 }
\ No newline at end of file
@@ -4,11 +4,23 @@
 #include <fstream>
 #include <iostream>
 #include "../Mesh/Model.h"
+#include "GeometryCodec.h"
 
 class NUILoader
 {
 public:
 
+	static constexpr std::uint32_t s_NuiMagic{ 0x0049554E };
+	static constexpr std::uint16_t s_NuiVersion{ 19 };
+
+	//Offset alignment of each attribute stream inside a submesh's vertex buffer
+	static constexpr size_t s_StreamAlignment{ 16 };
+
+	//Optional chunk tags
+	static constexpr std::uint32_t s_MeshletChunk{ 0x4C48534D };
+	static constexpr std::uint32_t s_ShadowMeshChunk{ 0x57444853 };
+	static constexpr std::uint32_t s_AnimatedBoundsChunk{ 0x444E4241 };
+
 	struct TempNodeData
 	{
 		glm::mat4 transformation;
@@ -30,10 +42,23 @@ public:
 	void  LoadCompiledBoneInfo(std::ifstream& ifs, std::unordered_map<std::string, BoneInfo>& map);
 	std::pair<std::string, Animation> LoadCompiledAnimation(std::ifstream& ifs);
 	Bone LoadCompiledBone(std::ifstream& ifs);
+	void LoadCompiledMeshlets(std::ifstream& ifs, Model& model);
+	void LoadCompiledShadowMeshes(std::ifstream& ifs, Model& model);
+	void LoadCompiledAnimatedBounds(std::ifstream& ifs, Model& model);
 	void LoadCompiledNodeData(NodeData& node_data, std::ifstream& ifs, std::uint32_t offset);
 
 	template <typename T>
 	void LoadVector(std::vector<T>& vec, std::ifstream& ifs);
+	template <typename T>
+	bool LoadGeometry(std::vector<T>& vec, GeometryCodec::Codec codec, std::ifstream& ifs);
+	bool LoadVertexStreams(std::vector<std::byte>& stream_data, GLintptr (&stream_offsets)[4], std::vector<glm::vec3>& positions, std::uint8_t streams, GeometryCodec::Codec codec, std::ifstream& ifs);
+	template <typename T>
+	bool AppendStream(std::vector<std::byte>& stream_data, GLintptr& stream_offset, std::vector<T>& stream, GeometryCodec::Codec codec, std::ifstream& ifs);
+	bool LoadIndices(std::vector<std::byte>& indices, std::uint8_t index_width, GeometryCodec::Codec codec, std::ifstream& ifs);
 	std::uint16_t LoadString(std::string& str, std::ifstream& ifs);
-	Model::SubMesh CreateSubMesh(std::vector<Model::Vertex>& vertices, std::vector<GLushort>& indices, std::pair<std::string, TempMaterial>& material);
+	Model::SubMesh CreateSubMesh(std::vector<Model::Vertex>& vertices, GLuint vbo, std::vector<std::byte>& indices, std::uint8_t index_width, std::pair<std::string, TempMaterial>& material);
+	template <typename T>
+	GLuint CreateVertexBuffer(std::vector<T>& vertex_data);
+	GLuint CreateIndexBuffer(std::vector<std::byte>& indices);
+	GLenum GetIndexType(std::uint8_t index_width);
 };
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+#include "glm/gtx/quaternion.hpp"
+
+//Rotation key interpolation shared by every track encoding, so all of them blend keys the same way
+struct Orientation
+{
+    //nlerp is only requested for tracks the compiler put in one hemisphere and checked against slerp
+    static glm::quat Interpolate(const glm::quat& from, const glm::quat& to, float factor, bool nlerp)
+    {
+        if (nlerp)
+        {
+            return glm::normalize(from * (1.0f - factor) + to * factor);
+        }
+
+        return glm::normalize(glm::slerp(from, to, factor));
+    }
+};
@@ -0,0 +1,100 @@
+#include "PoseEvaluator.h"
+#include "KeySearch.h"
+#include "Orientation.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	//KeySearch time accessor over float keys
+	template <typename Key>
+	auto TimeStamps(const std::vector<Key>& Keys)
+	{
+		return [&Keys](size_t Index) { return Keys[Index].m_TimeStamp; };
+	}
+}
+
+PoseEvaluator::TrackMap PoseEvaluator::GetTracks(const std::vector<Bone>& Bones)
+{
+	TrackMap tracks;
+
+	for (const auto& bone : Bones)
+		tracks[bone.GetBoneName()] = &bone;
+
+	return tracks;
+}
+
+void PoseEvaluator::ComputeGlobalTransforms(const NodeData& Node, const glm::mat4& ParentTransform, float Time, const TrackMap& Tracks,
+											const std::unordered_map<std::string, BoneInfo>& BoneInfoMap, std::vector<glm::mat4>& GlobalTransforms)
+{
+	auto track{ Tracks.find(Node.name) };
+	glm::mat4 transform{ ParentTransform * (track != Tracks.end() ? SampleLocalTransform(*track->second, Time) : Node.transformation) };
+
+	auto bone_info{ BoneInfoMap.find(Node.name) };
+
+	if (bone_info != BoneInfoMap.end() && bone_info->second.id < static_cast<int>(GlobalTransforms.size()))
+		GlobalTransforms[bone_info->second.id] = transform;
+
+	for (const auto& child : Node.children)
+		ComputeGlobalTransforms(child, transform, Time, Tracks, BoneInfoMap, GlobalTransforms);
+}
+
+glm::mat4 PoseEvaluator::SampleLocalTransform(const Bone& Track, float Time)
+{
+	return Bone::ComposeTransform(SamplePosition(Track, Time), SampleRotation(Track, Time), SampleScale(Track, Time));
+}
+
+glm::vec3 PoseEvaluator::SamplePosition(const Bone& Track, float Time)
+{
+	if (Track.m_Positions.empty())
+		return Track.m_BindPosition;
+
+	auto time_at{ TimeStamps(Track.m_Positions) };
+	size_t index{ KeySearch::Find(Track.m_Positions.size(), Time, time_at) };
+	size_t next{ (std::min)(index + 1, Track.m_Positions.size() - 1) };
+
+	return glm::mix(Track.m_Positions[index].m_Position, Track.m_Positions[next].m_Position, KeySearch::Factor(index, next, Time, time_at));
+}
+
+glm::quat PoseEvaluator::SampleRotation(const Bone& Track, float Time)
+{
+	if (Track.m_Rotations.empty())
+		return Track.m_BindRotation;
+
+	auto time_at{ TimeStamps(Track.m_Rotations) };
+	size_t index{ KeySearch::Find(Track.m_Rotations.size(), Time, time_at) };
+	size_t next{ (std::min)(index + 1, Track.m_Rotations.size() - 1) };
+
+	return Orientation::Interpolate(Track.m_Rotations[index].m_Orientation, Track.m_Rotations[next].m_Orientation, KeySearch::Factor(index, next, Time, time_at), false);
+}
+
+glm::vec3 PoseEvaluator::SampleScale(const Bone& Track, float Time)
+{
+	if (Track.m_Scales.empty())
+		return Track.m_BindScale;
+
+	auto time_at{ TimeStamps(Track.m_Scales) };
+	size_t index{ KeySearch::Find(Track.m_Scales.size(), Time, time_at) };
+	size_t next{ (std::min)(index + 1, Track.m_Scales.size() - 1) };
+
+	return glm::mix(Track.m_Scales[index].m_Scale, Track.m_Scales[next].m_Scale, KeySearch::Factor(index, next, Time, time_at));
+}
+
+float PoseEvaluator::GetTicksPerSecond(Animation& Clip)
+{
+	return Clip.GetTicksPerSecond() > 0.0f ? Clip.GetTicksPerSecond() : 25.0f;
+}
+
+float PoseEvaluator::RotationAngle(const glm::quat& From, const glm::quat& To)
+{
+	//atan2 of the difference rotation stays precise for the tiny angles acos loses in float
+	glm::quat difference{ glm::conjugate(glm::normalize(From)) * glm::normalize(To) };
+
+	return 2.0f * std::atan2(glm::length(glm::vec3{ difference.x, difference.y, difference.z }), std::abs(difference.w));
+}
+
+size_t PoseEvaluator::CountKeyBytes(const Bone& Track)
+{
+	return Track.m_Positions.size() * sizeof(KeyPosition) + Track.m_Rotations.size() * sizeof(KeyRotation) + Track.m_Scales.size() * sizeof(KeyScale);
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "CompiledModel.h"
+
+#include <algorithm>
+#include <execution>
+
+//Compile time pose evaluation for passes that need animated transforms (bounds, key reduction),
+//and the helpers every animation pass shares. Keys are clamped at track ends instead of running past them.
+class PoseEvaluator
+{
+public:
+	using TrackMap = std::unordered_map<std::string, const Bone*>;
+
+	static TrackMap GetTracks(const std::vector<Bone>& Bones);
+	//GlobalTransforms[bone id] receives the node to model transform of every node in BoneInfoMap
+	static void ComputeGlobalTransforms(const NodeData& Node, const glm::mat4& ParentTransform, float Time, const TrackMap& Tracks,
+										const std::unordered_map<std::string, BoneInfo>& BoneInfoMap, std::vector<glm::mat4>& GlobalTransforms);
+	static glm::mat4 SampleLocalTransform(const Bone& Track, float Time);
+	//single channels, the bind pose value when the track has no keys for it
+	static glm::vec3 SamplePosition(const Bone& Track, float Time);
+	static glm::quat SampleRotation(const Bone& Track, float Time);
+	static glm::vec3 SampleScale(const Bone& Track, float Time);
+	//clips without a tick rate play at Assimp's default of 25 ticks per second
+	static float GetTicksPerSecond(Animation& Clip);
+
+	//radians between two rotations, q and -q count as the same
+	static float RotationAngle(const glm::quat& From, const glm::quat& To);
+	//size of a track's float keys
+	static size_t CountKeyBytes(const Bone& Track);
+	//raises MaxPositionError / MaxRotationError to the largest error of Sample(time, position, rotation, scale)
+	//at Track's float position and rotation keys
+	template <typename Sampler>
+	static void MeasureKeyError(const Bone& Track, Sampler Sample, float& MaxPositionError, float& MaxRotationError);
+
+	//runs Process(name, clip, index) on every clip in parallel. index counts clips in Mesh.GetAnimations()
+	//order, so per clip results can go into a vector sized to the clip count
+	template <typename Function>
+	static void ForEachClip(CompiledModel& Mesh, Function Process);
+};
+
+template <typename Sampler>
+void PoseEvaluator::MeasureKeyError(const Bone& Track, Sampler Sample, float& MaxPositionError, float& MaxRotationError)
+{
+	glm::vec3 position{ 0.0f }, scale{ 1.0f };
+	glm::quat rotation{ 1.0f, 0.0f, 0.0f, 0.0f };
+
+	for (const auto& key : Track.m_Positions)
+	{
+		Sample(key.m_TimeStamp, position, rotation, scale);
+		MaxPositionError = (std::max)(MaxPositionError, glm::length(position - key.m_Position));
+	}
+
+	for (const auto& key : Track.m_Rotations)
+	{
+		Sample(key.m_TimeStamp, position, rotation, scale);
+		MaxRotationError = (std::max)(MaxRotationError, RotationAngle(key.m_Orientation, rotation));
+	}
+}
+
+template <typename Function>
+void PoseEvaluator::ForEachClip(CompiledModel& Mesh, Function Process)
+{
+	std::vector<std::pair<const std::string*, Animation*>> clips;
+
+	for (auto& [name, animation] : Mesh.GetAnimations())
+		clips.push_back({ &name, &animation });
+
+	std::for_each(std::execution::par, clips.begin(), clips.end(),
+				  [&](const std::pair<const std::string*, Animation*>& clip)
+				  {
+					  Process(*clip.first, *clip.second, static_cast<size_t>(&clip - clips.data()));
+				  });
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include "glm/gtx/quaternion.hpp"
+#include "KeySearch.h"
+#include "Orientation.h"
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define QUANTIZED_TRACK_SSE
+#include <emmintrin.h>
+#endif
+
+//Key value quantized to 16 bits per component, with a 16-bit frame index instead of a float timestamp (8 bytes)
+struct QuantizedKey
+{
+    std::uint16_t m_Value[3];
+    std::uint16_t m_Frame;
+};
+
+//Compact encoding of one bone's keys.
+//Positions and scales are quantized against the track's own range.
+//Rotations use smallest three: the largest component is dropped, the other three are stored in
+//[-1/sqrt(2), 1/sqrt(2)] with 15 bits for the first two and 16 for the third. The dropped
+//component's index goes in the low bits of the first two.
+struct QuantizedTrack
+{
+    std::vector<QuantizedKey> m_Positions;
+    std::vector<QuantizedKey> m_Rotations;
+    std::vector<QuantizedKey> m_Scales;
+
+    glm::vec3 m_PositionMin{ 0.0f };
+    glm::vec3 m_PositionExtent{ 0.0f };
+    glm::vec3 m_ScaleMin{ 1.0f };
+    glm::vec3 m_ScaleExtent{ 0.0f };
+    float m_FrameDuration{ 1.0f };              //ticks per frame index
+
+    static constexpr float s_RotationRange{ 0.70710678f };
+
+    static glm::vec3 DecodeVector(const QuantizedKey& key, const glm::vec3& min, const glm::vec3& extent)
+    {
+#ifdef QUANTIZED_TRACK_SSE
+        __m128i values{ _mm_setr_epi32(key.m_Value[0], key.m_Value[1], key.m_Value[2], 0) };
+        __m128 scale{ _mm_mul_ps(_mm_setr_ps(extent.x, extent.y, extent.z, 0.0f), _mm_set1_ps(1.0f / 65535.0f)) };
+        __m128 result{ _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(values), scale), _mm_setr_ps(min.x, min.y, min.z, 0.0f)) };
+
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, result);
+
+        return { lanes[0], lanes[1], lanes[2] };
+#else
+        return min + glm::vec3{ key.m_Value[0], key.m_Value[1], key.m_Value[2] } * (extent / 65535.0f);
+#endif
+    }
+
+    static glm::quat DecodeRotation(const QuantizedKey& key)
+    {
+        int largest{ (key.m_Value[0] & 1) | ((key.m_Value[1] & 1) << 1) };
+        float components[4];
+
+#ifdef QUANTIZED_TRACK_SSE
+        //first two lanes hold 15-bit values above their index bit
+        __m128i values{ _mm_and_si128(_mm_setr_epi32(key.m_Value[0], key.m_Value[1], key.m_Value[2], 0),
+                                      _mm_setr_epi32(0xFFFE, 0xFFFE, 0xFFFF, 0)) };
+        __m128 scale{ _mm_setr_ps(2.0f * s_RotationRange / 65534.0f, 2.0f * s_RotationRange / 65534.0f, 2.0f * s_RotationRange / 65535.0f, 0.0f) };
+        __m128 three{ _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(values), scale), _mm_setr_ps(s_RotationRange, s_RotationRange, s_RotationRange, 0.0f)) };
+
+        __m128 squared{ _mm_mul_ps(three, three) };
+        __m128 sum{ _mm_add_ss(_mm_add_ss(squared, _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(1, 1, 1, 1))),
+                               _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(2, 2, 2, 2))) };
+        __m128 dropped{ _mm_sqrt_ss(_mm_max_ss(_mm_sub_ss(_mm_set_ss(1.0f), sum), _mm_setzero_ps())) };
+
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, three);
+        float largest_value{ _mm_cvtss_f32(dropped) };
+#else
+        float lanes[3]{ (key.m_Value[0] & 0xFFFE) * (2.0f * s_RotationRange / 65534.0f) - s_RotationRange,
+                        (key.m_Value[1] & 0xFFFE) * (2.0f * s_RotationRange / 65534.0f) - s_RotationRange,
+                        key.m_Value[2] * (2.0f * s_RotationRange / 65535.0f) - s_RotationRange };
+        float largest_value{ std::sqrt((std::max)(0.0f, 1.0f - lanes[0] * lanes[0] - lanes[1] * lanes[1] - lanes[2] * lanes[2])) };
+#endif
+
+        //x, y, z, w order with the dropped component put back
+        for (int i = 0, lane = 0; i < 4; ++i)
+        {
+            components[i] = i == largest ? largest_value : lanes[lane++];
+        }
+
+        return glm::quat{ components[3], components[0], components[1], components[2] };
+    }
+
+    void Sample(float time, glm::vec3& position, glm::quat& rotation, glm::vec3& scale) const
+    {
+        float frame{ time / m_FrameDuration };
+        float factor{};
+        size_t index{};
+
+        if (!m_Positions.empty())
+        {
+            index = FindKey(m_Positions, frame, factor);
+            position = glm::mix(DecodeVector(m_Positions[index], m_PositionMin, m_PositionExtent),
+                                DecodeVector(m_Positions[NextKey(m_Positions, index)], m_PositionMin, m_PositionExtent), factor);
+        }
+
+        if (!m_Rotations.empty())
+        {
+            index = FindKey(m_Rotations, frame, factor);
+            rotation = Orientation::Interpolate(DecodeRotation(m_Rotations[index]), DecodeRotation(m_Rotations[NextKey(m_Rotations, index)]), factor, false);
+        }
+
+        if (!m_Scales.empty())
+        {
+            index = FindKey(m_Scales, frame, factor);
+            scale = glm::mix(DecodeVector(m_Scales[index], m_ScaleMin, m_ScaleExtent),
+                             DecodeVector(m_Scales[NextKey(m_Scales, index)], m_ScaleMin, m_ScaleExtent), factor);
+        }
+    }
+
+    //last key at or before frame, clamped to the track
+    static size_t FindKey(const std::vector<QuantizedKey>& keys, float frame, float& factor)
+    {
+        auto time_at = [&](size_t index) { return static_cast<float>(keys[index].m_Frame); };
+        size_t index{ KeySearch::Find(keys.size(), frame, time_at) };
+
+        factor = KeySearch::Factor(index, NextKey(keys, index), frame, time_at);
+
+        return index;
+    }
+
+    static size_t NextKey(const std::vector<QuantizedKey>& keys, size_t index)
+    {
+        return (std::min)(index + 1, keys.size() - 1);
+    }
+};
@@ -0,0 +1,93 @@
+#include "RotationAligner.h"
+#include "PoseEvaluator.h"
+#include "Orientation.h"
+
+#include <algorithm>
+#include <cmath>
+
+std::vector<RotationAligner::ClipReport> RotationAligner::AlignRotations(CompiledModel& Mesh, float MaxError)
+{
+	std::vector<ClipReport> reports(Mesh.GetAnimations().size());
+
+	PoseEvaluator::ForEachClip(Mesh,
+							   [&](const std::string& Name, Animation& Clip, size_t Index)
+							   {
+								   ClipReport& report{ reports[Index] };
+								   report = { Name, 0, 0, 0.0f };
+
+								   for (auto& bone : Clip.GetBones())
+								   {
+									   std::vector<glm::quat> rotations;
+
+									   if (bone.m_Encoding == TrackEncoding::Keys)
+									   {
+										   for (const auto& key : bone.m_Rotations)
+											   rotations.push_back(key.m_Orientation);
+									   }
+
+									   else if (bone.m_Encoding == TrackEncoding::Uniform)
+										   rotations = bone.m_Uniform.m_Rotations;
+
+									   else if (bone.m_Encoding == TrackEncoding::Timelines)
+										   rotations = bone.m_Timeline.m_Rotations;
+
+									   else
+										   continue;
+
+									   ++report.m_Tracks;
+									   float error{ AlignTrack(rotations) };
+
+									   if (bone.m_Encoding == TrackEncoding::Keys)
+									   {
+										   for (size_t i = 0; i < rotations.size(); ++i)
+											   bone.m_Rotations[i].m_Orientation = rotations[i];
+									   }
+
+									   else if (bone.m_Encoding == TrackEncoding::Uniform)
+										   bone.m_Uniform.m_Rotations = rotations;
+
+									   else
+										   bone.m_Timeline.m_Rotations = rotations;
+
+									   bone.m_Nlerp = error <= MaxError;
+
+									   if (bone.m_Nlerp)
+									   {
+										   ++report.m_NlerpTracks;
+										   report.m_MaxError = (std::max)(report.m_MaxError, error);
+									   }
+								   }
+							   });
+
+	return reports;
+}
+
+float RotationAligner::AlignTrack(std::vector<glm::quat>& Rotations)
+{
+	float error{};
+
+	for (size_t i = 1; i < Rotations.size(); ++i)
+	{
+		if (glm::dot(Rotations[i - 1], Rotations[i]) < 0.0f)
+			Rotations[i] = -Rotations[i];
+
+		error = (std::max)(error, MeasureNlerpError(Rotations[i - 1], Rotations[i]));
+	}
+
+	return error;
+}
+
+float RotationAligner::MeasureNlerpError(const glm::quat& From, const glm::quat& To)
+{
+	glm::quat from{ glm::normalize(From) }, to{ glm::normalize(To) };
+	float error{};
+
+	//nlerp matches slerp at both ends and the middle, the largest deviation lies in between
+	for (int step = 1; step < 10; ++step)
+	{
+		float factor{ step * 0.1f };
+		error = (std::max)(error, PoseEvaluator::RotationAngle(Orientation::Interpolate(from, to, factor, false), Orientation::Interpolate(from, to, factor, true)));
+	}
+
+	return error;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "CompiledModel.h"
+
+//Puts consecutive rotation keys in the same hemisphere and flags tracks whose rotations the runtime
+//may nlerp instead of slerp: every key pair where nlerp stays within MaxError of slerp.
+//Works on float keys, uniform tracks and timeline tracks. Quantized keys store a canonical sign and soa clips are
+//aligned when they are built, so both are left alone.
+class RotationAligner
+{
+public:
+	struct ClipReport
+	{
+		std::string m_Name;
+		size_t m_Tracks;
+		size_t m_NlerpTracks;
+		float m_MaxError;			//largest nlerp deviation from slerp of the flagged tracks, radians
+	};
+
+	static std::vector<ClipReport> AlignRotations(CompiledModel& Mesh, float MaxError);
+
+	//aligns Rotations in place, returns the largest nlerp deviation from slerp between neighbours
+	static float AlignTrack(std::vector<glm::quat>& Rotations);
+
+private:
+	static float MeasureNlerpError(const glm::quat& From, const glm::quat& To);
+};
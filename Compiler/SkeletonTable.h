@@ -0,0 +1,41 @@
+#pragma once
+#include "glm/glm.hpp"
+#include <vector>
+#include <cstdint>
+
+//Node of a clip's hierarchy, bound to its track and bone slot at compile time
+struct SkeletonNode
+{
+    std::int32_t m_Parent;              //index in SkeletonTable::m_Nodes, -1 for the root
+    std::int32_t m_Track;               //index in Animation::GetBones(), -1 when the node keeps m_BindTransform
+    std::int32_t m_BoneSlot;            //index in the final bone matrices (BoneInfo id), -1 when no bone uses the node
+    glm::mat4 m_BindTransform;          //node to parent space
+};
+
+//A clip's hierarchy flattened in pre-order so parents come before their children. Global transforms and
+//final bone matrices take one loop over m_Nodes, without walking NodeData or looking up tracks by name.
+struct SkeletonTable
+{
+    std::vector<SkeletonNode> m_Nodes;
+    std::vector<glm::mat4> m_Offsets;   //per bone slot, model space to bone space
+
+    //local_transforms per track, global_transforms is scratch space resized to the node count
+    void Evaluate(const std::vector<glm::mat4>& local_transforms, std::vector<glm::mat4>& global_transforms,
+                  std::vector<glm::mat4>& final_bone_matrices) const
+    {
+        global_transforms.resize(m_Nodes.size());
+
+        for (size_t i = 0; i < m_Nodes.size(); ++i)
+        {
+            const SkeletonNode& node{ m_Nodes[i] };
+            const glm::mat4& local{ node.m_Track < 0 ? node.m_BindTransform : local_transforms[node.m_Track] };
+
+            global_transforms[i] = node.m_Parent < 0 ? local : global_transforms[node.m_Parent] * local;
+
+            if (node.m_BoneSlot >= 0 && static_cast<size_t>(node.m_BoneSlot) < final_bone_matrices.size())
+            {
+                final_bone_matrices[node.m_BoneSlot] = global_transforms[i] * m_Offsets[node.m_BoneSlot];
+            }
+        }
+    }
+};
@@ -0,0 +1,204 @@
+#pragma once
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#define SOA_CLIP_AVX
+#include <immintrin.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define SOA_CLIP_SSE
+#include <emmintrin.h>
+#endif
+
+//Every bone of a clip resampled at one fixed rate and stored structure of arrays: per frame, one
+//stream per component (position x, y, z, rotation x, y, z, w, scale x, y, z) holding that component
+//for all bones. Evaluation interpolates 8 (AVX2), 4 (SSE) or 1 bone per instruction and writes the
+//local transforms of the whole skeleton in one pass. Rotations use nlerp: the compiler samples densely
+//and keeps consecutive samples of a bone in the same hemisphere.
+struct SoaClip
+{
+    //bones are padded to a multiple of this, padding lanes hold the identity transform
+    static constexpr std::uint32_t s_Lanes{ 8 };
+
+    enum Stream : std::uint32_t
+    {
+        Stream_PositionX, Stream_PositionY, Stream_PositionZ,
+        Stream_RotationX, Stream_RotationY, Stream_RotationZ, Stream_RotationW,
+        Stream_ScaleX, Stream_ScaleY, Stream_ScaleZ,
+        Stream_Count
+    };
+
+    std::uint32_t m_BoneCount{};                //in the order of Animation::GetBones()
+    std::uint32_t m_Stride{};                   //m_BoneCount rounded up to s_Lanes
+    std::uint32_t m_FrameCount{};
+    float m_SampleRate{ 1.0f };                 //frames per tick
+    std::vector<float> m_Samples;               //m_FrameCount * Stream_Count * m_Stride
+
+    bool Empty() const { return m_FrameCount == 0; }
+
+    const float* GetStream(size_t frame, size_t stream) const { return &m_Samples[(frame * Stream_Count + stream) * m_Stride]; }
+    float* GetStream(size_t frame, size_t stream) { return &m_Samples[(frame * Stream_Count + stream) * m_Stride]; }
+
+    //local_transforms needs m_BoneCount entries
+    void Evaluate(float time, std::vector<glm::mat4>& local_transforms) const
+    {
+        if (Empty())
+            return;
+
+        size_t frame0{}, frame1{};
+        float factor{ FindFrames(time, frame0, frame1) };
+        size_t bone{};
+
+#if defined(SOA_CLIP_AVX)
+        for (; bone < m_Stride; bone += AvxLanes::s_Width)
+            EvaluateBlock<AvxLanes>(frame0, frame1, factor, bone, local_transforms);
+#elif defined(SOA_CLIP_SSE)
+        for (; bone < m_Stride; bone += SseLanes::s_Width)
+            EvaluateBlock<SseLanes>(frame0, frame1, factor, bone, local_transforms);
+#endif
+
+        for (; bone < m_BoneCount; ++bone)
+            EvaluateBlock<ScalarLanes>(frame0, frame1, factor, bone, local_transforms);
+    }
+
+    //one bone's components, for tools and error measurement
+    void SampleBone(size_t bone, float time, glm::vec3& position, glm::quat& rotation, glm::vec3& scale) const
+    {
+        size_t frame0{}, frame1{};
+        float factor{ FindFrames(time, frame0, frame1) };
+
+        auto lerp = [&](size_t stream)
+        {
+            float a{ GetStream(frame0, stream)[bone] };
+            return a + (GetStream(frame1, stream)[bone] - a) * factor;
+        };
+
+        position = { lerp(Stream_PositionX), lerp(Stream_PositionY), lerp(Stream_PositionZ) };
+        rotation = glm::normalize(glm::quat{ lerp(Stream_RotationW), lerp(Stream_RotationX), lerp(Stream_RotationY), lerp(Stream_RotationZ) });
+        scale = { lerp(Stream_ScaleX), lerp(Stream_ScaleY), lerp(Stream_ScaleZ) };
+    }
+
+private:
+    float FindFrames(float time, size_t& frame0, size_t& frame1) const
+    {
+        float frame{ std::clamp(time * m_SampleRate, 0.0f, static_cast<float>(m_FrameCount - 1)) };
+
+        frame0 = static_cast<size_t>(frame);
+        frame1 = (std::min)(frame0 + 1, static_cast<size_t>(m_FrameCount - 1));
+
+        return frame - static_cast<float>(frame0);
+    }
+
+    struct ScalarLanes
+    {
+        using Type = float;
+        static constexpr size_t s_Width{ 1 };
+
+        static Type Load(const float* data) { return *data; }
+        static void Store(float* data, Type value) { *data = value; }
+        static Type Set(float value) { return value; }
+        static Type Add(Type a, Type b) { return a + b; }
+        static Type Sub(Type a, Type b) { return a - b; }
+        static Type Mul(Type a, Type b) { return a * b; }
+        static Type Div(Type a, Type b) { return a / b; }
+        static Type Sqrt(Type a) { return std::sqrt(a); }
+    };
+
+#ifdef SOA_CLIP_SSE
+    struct SseLanes
+    {
+        using Type = __m128;
+        static constexpr size_t s_Width{ 4 };
+
+        static Type Load(const float* data) { return _mm_loadu_ps(data); }
+        static void Store(float* data, Type value) { _mm_storeu_ps(data, value); }
+        static Type Set(float value) { return _mm_set1_ps(value); }
+        static Type Add(Type a, Type b) { return _mm_add_ps(a, b); }
+        static Type Sub(Type a, Type b) { return _mm_sub_ps(a, b); }
+        static Type Mul(Type a, Type b) { return _mm_mul_ps(a, b); }
+        static Type Div(Type a, Type b) { return _mm_div_ps(a, b); }
+        static Type Sqrt(Type a) { return _mm_sqrt_ps(a); }
+    };
+#endif
+
+#ifdef SOA_CLIP_AVX
+    struct AvxLanes
+    {
+        using Type = __m256;
+        static constexpr size_t s_Width{ 8 };
+
+        static Type Load(const float* data) { return _mm256_loadu_ps(data); }
+        static void Store(float* data, Type value) { _mm256_storeu_ps(data, value); }
+        static Type Set(float value) { return _mm256_set1_ps(value); }
+        static Type Add(Type a, Type b) { return _mm256_add_ps(a, b); }
+        static Type Sub(Type a, Type b) { return _mm256_sub_ps(a, b); }
+        static Type Mul(Type a, Type b) { return _mm256_mul_ps(a, b); }
+        static Type Div(Type a, Type b) { return _mm256_div_ps(a, b); }
+        static Type Sqrt(Type a) { return _mm256_sqrt_ps(a); }
+    };
+#endif
+
+    template <typename Lanes>
+    void EvaluateBlock(size_t frame0, size_t frame1, float factor, size_t bone, std::vector<glm::mat4>& local_transforms) const
+    {
+        using V = typename Lanes::Type;
+
+        V t{ Lanes::Set(factor) };
+        V one{ Lanes::Set(1.0f) };
+        V two{ Lanes::Set(2.0f) };
+
+        auto lerp = [&](size_t stream)
+        {
+            V a{ Lanes::Load(GetStream(frame0, stream) + bone) };
+            return Lanes::Add(a, Lanes::Mul(Lanes::Sub(Lanes::Load(GetStream(frame1, stream) + bone), a), t));
+        };
+
+        V qx{ lerp(Stream_RotationX) }, qy{ lerp(Stream_RotationY) }, qz{ lerp(Stream_RotationZ) }, qw{ lerp(Stream_RotationW) };
+
+        //nlerp, then 2 / |q|^2 folds the normalisation into the rotation matrix terms
+        V length2{ Lanes::Add(Lanes::Add(Lanes::Mul(qx, qx), Lanes::Mul(qy, qy)), Lanes::Add(Lanes::Mul(qz, qz), Lanes::Mul(qw, qw))) };
+        V s{ Lanes::Div(two, length2) };
+
+        V xs{ Lanes::Mul(qx, s) }, ys{ Lanes::Mul(qy, s) }, zs{ Lanes::Mul(qz, s) };
+        V xx{ Lanes::Mul(qx, xs) }, yy{ Lanes::Mul(qy, ys) }, zz{ Lanes::Mul(qz, zs) };
+        V xy{ Lanes::Mul(qx, ys) }, xz{ Lanes::Mul(qx, zs) }, yz{ Lanes::Mul(qy, zs) };
+        V wx{ Lanes::Mul(qw, xs) }, wy{ Lanes::Mul(qw, ys) }, wz{ Lanes::Mul(qw, zs) };
+
+        V sx{ lerp(Stream_ScaleX) }, sy{ lerp(Stream_ScaleY) }, sz{ lerp(Stream_ScaleZ) };
+
+        //columns of translate * rotate * scale, rows 0 to 2
+        float columns[12][Lanes::s_Width];
+
+        Lanes::Store(columns[0], Lanes::Mul(Lanes::Sub(one, Lanes::Add(yy, zz)), sx));
+        Lanes::Store(columns[1], Lanes::Mul(Lanes::Add(xy, wz), sx));
+        Lanes::Store(columns[2], Lanes::Mul(Lanes::Sub(xz, wy), sx));
+
+        Lanes::Store(columns[3], Lanes::Mul(Lanes::Sub(xy, wz), sy));
+        Lanes::Store(columns[4], Lanes::Mul(Lanes::Sub(one, Lanes::Add(xx, zz)), sy));
+        Lanes::Store(columns[5], Lanes::Mul(Lanes::Add(yz, wx), sy));
+
+        Lanes::Store(columns[6], Lanes::Mul(Lanes::Add(xz, wy), sz));
+        Lanes::Store(columns[7], Lanes::Mul(Lanes::Sub(yz, wx), sz));
+        Lanes::Store(columns[8], Lanes::Mul(Lanes::Sub(one, Lanes::Add(xx, yy)), sz));
+
+        Lanes::Store(columns[9], lerp(Stream_PositionX));
+        Lanes::Store(columns[10], lerp(Stream_PositionY));
+        Lanes::Store(columns[11], lerp(Stream_PositionZ));
+
+        for (size_t lane = 0; lane < Lanes::s_Width && bone + lane < m_BoneCount; ++lane)
+        {
+            glm::mat4& transform{ local_transforms[bone + lane] };
+
+            for (int column = 0; column < 4; ++column)
+            {
+                transform[column] = glm::vec4{ columns[column * 3][lane], columns[column * 3 + 1][lane], columns[column * 3 + 2][lane], column == 3 ? 1.0f : 0.0f };
+            }
+        }
+    }
+};
@@ -0,0 +1,120 @@
+#include "StaticChannelReducer.h"
+#include "PoseEvaluator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	//keys count as equal within float noise of the source transforms
+	constexpr float s_Epsilon{ 1e-5f };
+
+	bool SameVector(const glm::vec3& Lhs, const glm::vec3& Rhs)
+	{
+		glm::vec3 difference{ glm::abs(Lhs - Rhs) };
+		return (std::max)({ difference.x, difference.y, difference.z }) <= s_Epsilon * (std::max)({ 1.0f, glm::length(Lhs), glm::length(Rhs) });
+	}
+
+	bool SameRotation(const glm::quat& Lhs, const glm::quat& Rhs)
+	{
+		return PoseEvaluator::RotationAngle(Lhs, Rhs) <= s_Epsilon;
+	}
+}
+
+std::vector<StaticChannelReducer::ClipReport> StaticChannelReducer::ReduceStaticChannels(CompiledModel& Mesh)
+{
+	std::vector<ClipReport> reports(Mesh.GetAnimations().size());
+
+	PoseEvaluator::ForEachClip(Mesh,
+							   [&](const std::string& Name, Animation& Clip, size_t Index)
+							   {
+								   ClipReport& report{ reports[Index] };
+								   report = { Name, 0, 0, 0, 0, 0, 0 };
+
+								   std::unordered_map<std::string, glm::mat4> bind_transforms;
+								   FindBindTransforms(Clip.GetRootNode(), bind_transforms);
+
+								   std::vector<Bone> bones;
+
+								   for (auto& bone : Clip.GetBones())
+								   {
+									   report.m_BytesBefore += PoseEvaluator::CountKeyBytes(bone);
+
+									   //tracks of nodes missing from the hierarchy keep the identity bind pose
+									   auto bind{ bind_transforms.find(bone.GetBoneName()) };
+
+									   if (bind != bind_transforms.end())
+										   DecomposeTransform(bind->second, bone.m_BindPosition, bone.m_BindRotation, bone.m_BindScale);
+
+									   ReduceChannel(bone.m_Positions, &KeyPosition::m_Position, bone.m_BindPosition, SameVector, report);
+									   ReduceChannel(bone.m_Rotations, &KeyRotation::m_Orientation, bone.m_BindRotation, SameRotation, report);
+									   ReduceChannel(bone.m_Scales, &KeyScale::m_Scale, bone.m_BindScale, SameVector, report);
+
+									   if (bone.m_Positions.empty() && bone.m_Rotations.empty() && bone.m_Scales.empty())
+									   {
+										   ++report.m_RemovedTracks;
+										   continue;
+									   }
+
+									   report.m_BytesAfter += PoseEvaluator::CountKeyBytes(bone);
+									   bones.push_back(std::move(bone));
+								   }
+
+								   Clip.SetBones(std::move(bones));
+							   });
+
+	return reports;
+}
+
+void StaticChannelReducer::DecomposeTransform(const glm::mat4& Transform, glm::vec3& Position, glm::quat& Rotation, glm::vec3& Scale)
+{
+	glm::mat3 basis{ Transform };
+
+	Position = glm::vec3{ Transform[3] };
+	Scale = { glm::length(basis[0]), glm::length(basis[1]), glm::length(basis[2]) };
+
+	//a mirrored basis keeps a proper rotation with one negative scale
+	if (glm::determinant(basis) < 0.0f)
+		Scale.x = -Scale.x;
+
+	for (int i = 0; i < 3; ++i)
+	{
+		if (Scale[i] != 0.0f)
+			basis[i] /= Scale[i];
+	}
+
+	Rotation = glm::normalize(glm::quat_cast(basis));
+}
+
+void StaticChannelReducer::FindBindTransforms(const NodeData& Node, std::unordered_map<std::string, glm::mat4>& Transforms)
+{
+	Transforms[Node.name] = Node.transformation;
+
+	for (const auto& child : Node.children)
+		FindBindTransforms(child, Transforms);
+}
+
+template <typename Key, typename Value, typename Equal>
+void StaticChannelReducer::ReduceChannel(std::vector<Key>& Keys, Value Key::*Member, const Value& Bind, Equal Same, ClipReport& Report)
+{
+	if (Keys.empty())
+		return;
+
+	++Report.m_Channels;
+
+	if (!std::all_of(Keys.begin(), Keys.end(), [&](const Key& key) { return Same(key.*Member, Keys.front().*Member); }))
+		return;
+
+	if (Same(Keys.front().*Member, Bind))
+	{
+		++Report.m_Dropped;
+		Keys.clear();
+		return;
+	}
+
+	if (Keys.size() > 1)
+	{
+		++Report.m_Collapsed;
+		Keys.resize(1);
+	}
+}
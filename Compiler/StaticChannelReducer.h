@@ -0,0 +1,32 @@
+#pragma once
+#include "CompiledModel.h"
+
+//Stores every bone's bind pose translation, rotation and scale with its track, collapses channels
+//that never change to a single key and drops channels that never leave the bind value, so the
+//evaluator falls back to it. Tracks left without any channel are removed from their clip, the
+//node then keeps its bind transform like any other unanimated node.
+class StaticChannelReducer
+{
+public:
+	struct ClipReport
+	{
+		std::string m_Name;
+		size_t m_Channels;
+		size_t m_Collapsed;			//constant, stored as one key
+		size_t m_Dropped;			//equal to the bind pose, no keys
+		size_t m_RemovedTracks;
+		size_t m_BytesBefore;
+		size_t m_BytesAfter;
+	};
+
+	static std::vector<ClipReport> ReduceStaticChannels(CompiledModel& Mesh);
+
+	static void DecomposeTransform(const glm::mat4& Transform, glm::vec3& Position, glm::quat& Rotation, glm::vec3& Scale);
+
+private:
+	static void FindBindTransforms(const NodeData& Node, std::unordered_map<std::string, glm::mat4>& Transforms);
+
+	//collapses a constant channel to its first key, or drops it when that equals Bind
+	template <typename Key, typename Value, typename Equal>
+	static void ReduceChannel(std::vector<Key>& Keys, Value Key::*Member, const Value& Bind, Equal Same, ClipReport& Report);
+};
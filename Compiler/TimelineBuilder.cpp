@@ -0,0 +1,77 @@
+#include "TimelineBuilder.h"
+#include "PoseEvaluator.h"
+
+#include <algorithm>
+
+std::vector<TimelineBuilder::ClipReport> TimelineBuilder::ShareTimelines(CompiledModel& Mesh)
+{
+	std::vector<ClipReport> reports(Mesh.GetAnimations().size());
+
+	PoseEvaluator::ForEachClip(Mesh,
+							   [&](const std::string& Name, Animation& Clip, size_t Index)
+							   {
+								   ClipReport& report{ reports[Index] };
+								   report = { Name, 0, 0, 0, 0 };
+
+								   KeyTimelines timelines;
+								   timelines.m_Offsets.push_back(0);
+
+								   std::map<std::vector<float>, std::uint32_t> lookup;
+
+								   for (auto& bone : Clip.GetBones())
+								   {
+									   TimelineTrack& track{ bone.m_Timeline };
+
+									   track.m_PositionTimeline = ShareChannel(bone.m_Positions, &KeyPosition::m_Position, track.m_Positions, lookup, timelines, report);
+									   track.m_RotationTimeline = ShareChannel(bone.m_Rotations, &KeyRotation::m_Orientation, track.m_Rotations, lookup, timelines, report);
+									   track.m_ScaleTimeline = ShareChannel(bone.m_Scales, &KeyScale::m_Scale, track.m_Scales, lookup, timelines, report);
+									   bone.m_Encoding = TrackEncoding::Timelines;
+
+									   report.m_BytesBefore += PoseEvaluator::CountKeyBytes(bone);
+									   report.m_BytesAfter += track.m_Positions.size() * sizeof(glm::vec3) + track.m_Rotations.size() * sizeof(glm::quat) + track.m_Scales.size() * sizeof(glm::vec3)
+															  + sizeof(std::uint32_t) * 3;
+								   }
+
+								   report.m_Timelines = timelines.Count();
+								   report.m_BytesAfter += timelines.m_Times.size() * sizeof(float) + timelines.m_Offsets.size() * sizeof(std::uint32_t);
+
+								   Clip.SetTimelines(std::move(timelines));
+							   });
+
+	return reports;
+}
+
+std::uint32_t TimelineBuilder::FindTimeline(const std::vector<float>& Times, std::map<std::vector<float>, std::uint32_t>& Lookup, KeyTimelines& Timelines)
+{
+	auto [timeline, added] { Lookup.insert({ Times, static_cast<std::uint32_t>(Timelines.Count()) }) };
+
+	if (added)
+	{
+		Timelines.m_Times.insert(Timelines.m_Times.end(), Times.begin(), Times.end());
+		Timelines.m_Offsets.push_back(static_cast<std::uint32_t>(Timelines.m_Times.size()));
+	}
+
+	return timeline->second;
+}
+
+template <typename Key, typename Value>
+std::uint32_t TimelineBuilder::ShareChannel(const std::vector<Key>& Keys, Value Key::*Member, std::vector<Value>& Values,
+											std::map<std::vector<float>, std::uint32_t>& Lookup, KeyTimelines& Timelines, ClipReport& Report)
+{
+	Values.clear();
+
+	if (Keys.empty())
+		return TimelineTrack::s_NoTimeline;
+
+	std::vector<float> times;
+
+	for (const auto& key : Keys)
+	{
+		times.push_back(key.m_TimeStamp);
+		Values.push_back(key.*Member);
+	}
+
+	++Report.m_Channels;
+
+	return FindTimeline(times, Lookup, Timelines);
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "CompiledModel.h"
+#include <map>
+
+//Converts bone keys to TimelineTrack: every distinct timestamp array of a clip is stored once in
+//the clip's KeyTimelines and channels keep only their values plus the index of their timeline.
+class TimelineBuilder
+{
+public:
+	struct ClipReport
+	{
+		std::string m_Name;
+		size_t m_Channels;
+		size_t m_Timelines;
+		size_t m_BytesBefore;
+		size_t m_BytesAfter;
+	};
+
+	//Marks every bone of every clip TrackEncoding::Timelines
+	static std::vector<ClipReport> ShareTimelines(CompiledModel& Mesh);
+
+private:
+	//index of Times in Timelines, added when no timeline matches it exactly
+	static std::uint32_t FindTimeline(const std::vector<float>& Times, std::map<std::vector<float>, std::uint32_t>& Lookup, KeyTimelines& Timelines);
+
+	template <typename Key, typename Value>
+	static std::uint32_t ShareChannel(const std::vector<Key>& Keys, Value Key::*Member, std::vector<Value>& Values,
+									  std::map<std::vector<float>, std::uint32_t>& Lookup, KeyTimelines& Timelines, ClipReport& Report);
+};
@@ -0,0 +1,159 @@
+#include "TrackQuantizer.h"
+#include "PoseEvaluator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+std::vector<TrackQuantizer::ClipReport> TrackQuantizer::QuantizeTracks(CompiledModel& Mesh)
+{
+	std::vector<ClipReport> reports(Mesh.GetAnimations().size());
+
+	PoseEvaluator::ForEachClip(Mesh,
+							   [&](const std::string& Name, Animation& Clip, size_t Index)
+							   {
+								   ClipReport& report{ reports[Index] };
+								   report = { Name, 0, 0, 0.0f, 0.0f };
+
+								   std::vector<Bone> bones{ Clip.GetBones() };
+
+								   for (auto& bone : bones)
+								   {
+									   bone.m_Quantized = Quantize(bone);
+									   bone.m_Encoding = TrackEncoding::Quantized;
+
+									   const QuantizedTrack& track{ bone.m_Quantized };
+
+									   report.m_BytesBefore += PoseEvaluator::CountKeyBytes(bone);
+									   report.m_BytesAfter += (track.m_Positions.size() + track.m_Rotations.size() + track.m_Scales.size()) * sizeof(QuantizedKey)
+															  + sizeof(glm::vec3) * 4 + sizeof(float);
+
+									   for (size_t i = 0; i < bone.m_Positions.size(); ++i)
+									   {
+										   glm::vec3 position{ QuantizedTrack::DecodeVector(track.m_Positions[i], track.m_PositionMin, track.m_PositionExtent) };
+										   report.m_MaxPositionError = (std::max)(report.m_MaxPositionError, glm::length(position - bone.m_Positions[i].m_Position));
+									   }
+
+									   for (size_t i = 0; i < bone.m_Rotations.size(); ++i)
+									   {
+										   float angle{ PoseEvaluator::RotationAngle(bone.m_Rotations[i].m_Orientation, QuantizedTrack::DecodeRotation(track.m_Rotations[i])) };
+										   report.m_MaxRotationError = (std::max)(report.m_MaxRotationError, angle);
+									   }
+								   }
+
+								   Clip.SetBones(std::move(bones));
+							   });
+
+	return reports;
+}
+
+QuantizedTrack TrackQuantizer::Quantize(const Bone& Track)
+{
+	QuantizedTrack track;
+	track.m_FrameDuration = ComputeFrameDuration(Track);
+
+	QuantizeVectors(Track.m_Positions, &KeyPosition::m_Position, track.m_FrameDuration, track.m_Positions, track.m_PositionMin, track.m_PositionExtent);
+	QuantizeVectors(Track.m_Scales, &KeyScale::m_Scale, track.m_FrameDuration, track.m_Scales, track.m_ScaleMin, track.m_ScaleExtent);
+
+	for (const auto& key : Track.m_Rotations)
+		track.m_Rotations.push_back(QuantizeRotation(key.m_Orientation, ToFrame(key.m_TimeStamp, track.m_FrameDuration)));
+
+	return track;
+}
+
+float TrackQuantizer::ComputeFrameDuration(const Bone& Track)
+{
+	float last_time{};
+	bool integral{ true };
+
+	auto visit = [&](float TimeStamp)
+	{
+		last_time = (std::max)(last_time, TimeStamp);
+		integral = integral && std::abs(TimeStamp - std::round(TimeStamp)) < 1e-3f;
+	};
+
+	for (const auto& key : Track.m_Positions) visit(key.m_TimeStamp);
+	for (const auto& key : Track.m_Rotations) visit(key.m_TimeStamp);
+	for (const auto& key : Track.m_Scales) visit(key.m_TimeStamp);
+
+	//keys on whole ticks keep their exact times, anything else spreads the track over the full 16-bit range
+	constexpr float max_frame{ std::numeric_limits<std::uint16_t>::max() };
+
+	if ((integral && last_time <= max_frame) || last_time <= 0.0f)
+		return 1.0f;
+
+	return last_time / max_frame;
+}
+
+template <typename Key>
+void TrackQuantizer::QuantizeVectors(const std::vector<Key>& Keys, glm::vec3 Key::*Value, float FrameDuration,
+									 std::vector<QuantizedKey>& Result, glm::vec3& Min, glm::vec3& Extent)
+{
+	if (Keys.empty())
+		return;
+
+	glm::vec3 min{ Keys[0].*Value }, max{ min };
+
+	for (const auto& key : Keys)
+	{
+		min = glm::min(min, key.*Value);
+		max = glm::max(max, key.*Value);
+	}
+
+	Min = min;
+	Extent = max - min;
+
+	for (const auto& key : Keys)
+	{
+		QuantizedKey quantized{ {}, ToFrame(key.m_TimeStamp, FrameDuration) };
+
+		for (int i = 0; i < 3; ++i)
+		{
+			float normalized{ Extent[i] > 0.0f ? ((key.*Value)[i] - Min[i]) / Extent[i] : 0.0f };
+			quantized.m_Value[i] = static_cast<std::uint16_t>(std::round(std::clamp(normalized, 0.0f, 1.0f) * 65535.0f));
+		}
+
+		Result.push_back(quantized);
+	}
+}
+
+QuantizedKey TrackQuantizer::QuantizeRotation(const glm::quat& Rotation, std::uint16_t Frame)
+{
+	glm::quat rotation{ glm::normalize(Rotation) };
+	float components[4]{ rotation.x, rotation.y, rotation.z, rotation.w };
+	int largest{};
+
+	for (int i = 1; i < 4; ++i)
+	{
+		if (std::abs(components[i]) > std::abs(components[largest]))
+			largest = i;
+	}
+
+	//q and -q are the same rotation, so the dropped component is always positive
+	float sign{ components[largest] < 0.0f ? -1.0f : 1.0f };
+	float range{ QuantizedTrack::s_RotationRange };
+	QuantizedKey key{ {}, Frame };
+
+	for (int i = 0, lane = 0; i < 4; ++i)
+	{
+		if (i == largest)
+			continue;
+
+		float normalized{ std::clamp((components[i] * sign + range) / (2.0f * range), 0.0f, 1.0f) };
+
+		//first two lanes keep 15 bits, their low bit carries the dropped component's index
+		if (lane < 2)
+			key.m_Value[lane] = static_cast<std::uint16_t>((static_cast<std::uint16_t>(std::round(normalized * 32767.0f)) << 1) | ((largest >> lane) & 1));
+		else
+			key.m_Value[lane] = static_cast<std::uint16_t>(std::round(normalized * 65535.0f));
+
+		++lane;
+	}
+
+	return key;
+}
+
+std::uint16_t TrackQuantizer::ToFrame(float TimeStamp, float FrameDuration)
+{
+	return static_cast<std::uint16_t>(std::clamp(std::round(TimeStamp / FrameDuration), 0.0f, 65535.0f));
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "CompiledModel.h"
+
+//Converts bone keys to QuantizedTrack: 16-bit components against per-track ranges for positions
+//and scales, smallest three for rotations and 16-bit frame indices instead of float timestamps.
+class TrackQuantizer
+{
+public:
+	struct ClipReport
+	{
+		std::string m_Name;
+		size_t m_BytesBefore;
+		size_t m_BytesAfter;
+		float m_MaxPositionError;	//local units, at the keys
+		float m_MaxRotationError;	//radians, at the keys
+	};
+
+	//Marks every bone of every clip quantized
+	static std::vector<ClipReport> QuantizeTracks(CompiledModel& Mesh);
+
+	static QuantizedTrack Quantize(const Bone& Track);
+
+private:
+	static float ComputeFrameDuration(const Bone& Track);
+
+	template <typename Key>
+	static void QuantizeVectors(const std::vector<Key>& Keys, glm::vec3 Key::*Value, float FrameDuration,
+								std::vector<QuantizedKey>& Result, glm::vec3& Min, glm::vec3& Extent);
+
+	static QuantizedKey QuantizeRotation(const glm::quat& Rotation, std::uint16_t Frame);
+	static std::uint16_t ToFrame(float TimeStamp, float FrameDuration);
+};
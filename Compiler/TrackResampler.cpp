@@ -0,0 +1,183 @@
+#include "TrackResampler.h"
+#include "PoseEvaluator.h"
+
+#include <algorithm>
+#include <cmath>
+
+std::vector<TrackResampler::ClipReport> TrackResampler::ResampleTracks(CompiledModel& Mesh, float SampleRate)
+{
+	std::vector<ClipReport> reports(Mesh.GetAnimations().size());
+
+	PoseEvaluator::ForEachClip(Mesh,
+							   [&](const std::string& Name, Animation& Clip, size_t Index)
+							   {
+								   ClipReport& report{ reports[Index] };
+								   report = { Name, 0, 0, 0, 0, 0.0f, 0.0f };
+
+								   float duration{ Clip.GetDuration() };
+								   float samples_per_tick{ GetSamplesPerTick(Clip, SampleRate) };
+
+								   std::vector<Bone> bones{ Clip.GetBones() };
+
+								   for (auto& bone : bones)
+								   {
+									   bone.m_Uniform = Resample(bone, duration, samples_per_tick);
+									   bone.m_Encoding = TrackEncoding::Uniform;
+
+									   const UniformTrack& track{ bone.m_Uniform };
+
+									   report.m_SamplesAfter += track.m_Positions.size() + track.m_Rotations.size() + track.m_Scales.size();
+									   report.m_BytesAfter += track.m_Positions.size() * sizeof(glm::vec3) + track.m_Rotations.size() * sizeof(glm::quat)
+															  + track.m_Scales.size() * sizeof(glm::vec3) + sizeof(float);
+
+									   CountSourceKeys(bone, report);
+									   PoseEvaluator::MeasureKeyError(bone, [&](float Time, glm::vec3& Position, glm::quat& Rotation, glm::vec3& Scale)
+																	  {
+																		  track.Sample(Time, Position, Rotation, Scale);
+																	  }, report.m_MaxPositionError, report.m_MaxRotationError);
+								   }
+
+								   Clip.SetBones(std::move(bones));
+							   });
+
+	return reports;
+}
+
+std::vector<TrackResampler::ClipReport> TrackResampler::ResampleClips(CompiledModel& Mesh, float SampleRate)
+{
+	std::vector<ClipReport> reports(Mesh.GetAnimations().size());
+
+	PoseEvaluator::ForEachClip(Mesh,
+							   [&](const std::string& Name, Animation& Clip, size_t Index)
+							   {
+								   ClipReport& report{ reports[Index] };
+								   report = { Name, 0, 0, 0, 0, 0.0f, 0.0f };
+
+								   SoaClip soa_tracks{ ResampleClip(Clip, SampleRate) };
+								   std::vector<Bone> bones{ Clip.GetBones() };
+
+								   report.m_SamplesAfter = static_cast<size_t>(soa_tracks.m_FrameCount) * soa_tracks.m_BoneCount * 3;
+								   report.m_BytesAfter = soa_tracks.m_Samples.size() * sizeof(float) + sizeof(std::uint32_t) * 3 + sizeof(float);
+
+								   for (size_t i = 0; i < bones.size(); ++i)
+								   {
+									   CountSourceKeys(bones[i], report);
+									   PoseEvaluator::MeasureKeyError(bones[i], [&](float Time, glm::vec3& Position, glm::quat& Rotation, glm::vec3& Scale)
+																	  {
+																		  soa_tracks.SampleBone(i, Time, Position, Rotation, Scale);
+																	  }, report.m_MaxPositionError, report.m_MaxRotationError);
+
+									   bones[i].m_Encoding = TrackEncoding::Soa;
+								   }
+
+								   Clip.SetBones(std::move(bones));
+								   Clip.SetSoaTracks(std::move(soa_tracks));
+							   });
+
+	return reports;
+}
+
+SoaClip TrackResampler::ResampleClip(Animation& Clip, float SampleRate)
+{
+	SoaClip soa_tracks;
+	const std::vector<Bone>& bones{ Clip.GetBones() };
+
+	if (bones.empty())
+		return soa_tracks;
+
+	float samples_per_tick{ GetSamplesPerTick(Clip, SampleRate) };
+
+	soa_tracks.m_BoneCount = static_cast<std::uint32_t>(bones.size());
+	soa_tracks.m_Stride = (soa_tracks.m_BoneCount + SoaClip::s_Lanes - 1) / SoaClip::s_Lanes * SoaClip::s_Lanes;
+	soa_tracks.m_FrameCount = static_cast<std::uint32_t>(std::round((std::max)(Clip.GetDuration(), 0.0f) * samples_per_tick)) + 1;
+	soa_tracks.m_SampleRate = samples_per_tick;
+	soa_tracks.m_Samples.resize(static_cast<size_t>(soa_tracks.m_FrameCount) * SoaClip::Stream_Count * soa_tracks.m_Stride);
+
+	for (size_t frame = 0; frame < soa_tracks.m_FrameCount; ++frame)
+	{
+		float time{ static_cast<float>(frame) / samples_per_tick };
+
+		for (size_t bone = 0; bone < soa_tracks.m_Stride; ++bone)
+		{
+			glm::vec3 position{ 0.0f };
+			glm::quat rotation{ 1.0f, 0.0f, 0.0f, 0.0f };
+			glm::vec3 scale{ 1.0f };
+
+			//padding lanes keep the identity transform
+			if (bone < bones.size())
+			{
+				position = PoseEvaluator::SamplePosition(bones[bone], time);
+				rotation = PoseEvaluator::SampleRotation(bones[bone], time);
+				scale = PoseEvaluator::SampleScale(bones[bone], time);
+
+				//nlerp between frames needs both in the same hemisphere
+				if (frame)
+				{
+					glm::quat previous{ soa_tracks.GetStream(frame - 1, SoaClip::Stream_RotationW)[bone], soa_tracks.GetStream(frame - 1, SoaClip::Stream_RotationX)[bone],
+										soa_tracks.GetStream(frame - 1, SoaClip::Stream_RotationY)[bone], soa_tracks.GetStream(frame - 1, SoaClip::Stream_RotationZ)[bone] };
+
+					if (glm::dot(previous, rotation) < 0.0f)
+						rotation = -rotation;
+				}
+			}
+
+			float components[SoaClip::Stream_Count]{ position.x, position.y, position.z, rotation.x, rotation.y, rotation.z, rotation.w, scale.x, scale.y, scale.z };
+
+			for (size_t stream = 0; stream < SoaClip::Stream_Count; ++stream)
+				soa_tracks.GetStream(frame, stream)[bone] = components[stream];
+		}
+	}
+
+	return soa_tracks;
+}
+
+void TrackResampler::CountSourceKeys(const Bone& Track, ClipReport& Report)
+{
+	Report.m_KeysBefore += Track.m_Positions.size() + Track.m_Rotations.size() + Track.m_Scales.size();
+	Report.m_BytesBefore += PoseEvaluator::CountKeyBytes(Track);
+}
+
+float TrackResampler::GetSamplesPerTick(Animation& Clip, float SampleRate)
+{
+	//whole number of intervals over the clip, at least one
+	float duration{ Clip.GetDuration() };
+	float intervals{ (std::max)(std::round(duration * SampleRate / PoseEvaluator::GetTicksPerSecond(Clip)), 1.0f) };
+
+	return duration > 0.0f ? intervals / duration : 1.0f;
+}
+
+UniformTrack TrackResampler::Resample(const Bone& Track, float Duration, float SamplesPerTick)
+{
+	UniformTrack track;
+	track.m_SampleRate = SamplesPerTick;
+
+	size_t count{ static_cast<size_t>(std::round((std::max)(Duration, 0.0f) * SamplesPerTick)) + 1 };
+
+	ResampleChannel(Track.m_Positions, &KeyPosition::m_Position, Track, count, SamplesPerTick, &PoseEvaluator::SamplePosition, track.m_Positions);
+	ResampleChannel(Track.m_Rotations, &KeyRotation::m_Orientation, Track, count, SamplesPerTick, &PoseEvaluator::SampleRotation, track.m_Rotations);
+	ResampleChannel(Track.m_Scales, &KeyScale::m_Scale, Track, count, SamplesPerTick, &PoseEvaluator::SampleScale, track.m_Scales);
+
+	return track;
+}
+
+template <typename Key, typename Value, typename Sampler>
+void TrackResampler::ResampleChannel(const std::vector<Key>& Keys, Value Key::*Member, const Bone& Track, size_t Count, float SamplesPerTick,
+									 Sampler Sample, std::vector<Value>& Result)
+{
+	if (Keys.empty())
+		return;
+
+	//a channel that never changes needs a single sample
+	bool constant{ std::all_of(Keys.begin(), Keys.end(), [&](const Key& key) { return key.*Member == Keys[0].*Member; }) };
+
+	if (constant)
+	{
+		Result.push_back(Keys[0].*Member);
+		return;
+	}
+
+	Result.reserve(Count);
+
+	for (size_t i = 0; i < Count; ++i)
+		Result.push_back(Sample(Track, static_cast<float>(i) / SamplesPerTick));
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "CompiledModel.h"
+
+//Resamples bone keys to UniformTrack, a fixed rate per clip so the runtime finds keys by
+//index = floor(time * rate) instead of searching timestamps.
+class TrackResampler
+{
+public:
+	struct ClipReport
+	{
+		std::string m_Name;
+		size_t m_KeysBefore;
+		size_t m_SamplesAfter;
+		size_t m_BytesBefore;
+		size_t m_BytesAfter;
+		float m_MaxPositionError;	//local units, at the original key times
+		float m_MaxRotationError;	//radians, at the original key times
+	};
+
+	//SampleRate is in samples per second, rounded per clip so a sample lands on the clip's last tick.
+	//Marks every bone of every clip uniform.
+	static std::vector<ClipReport> ResampleTracks(CompiledModel& Mesh, float SampleRate);
+
+	//Same rate as ResampleTracks, but every bone of a clip goes into one SoaClip and the bones are marked TrackEncoding::Soa
+	static std::vector<ClipReport> ResampleClips(CompiledModel& Mesh, float SampleRate);
+
+	static UniformTrack Resample(const Bone& Track, float Duration, float SamplesPerTick);
+	static SoaClip ResampleClip(Animation& Clip, float SampleRate);
+
+private:
+	static float GetSamplesPerTick(Animation& Clip, float SampleRate);
+
+	//adds the track's float keys and their size to Report
+	static void CountSourceKeys(const Bone& Track, ClipReport& Report);
+
+	template <typename Key, typename Value, typename Sampler>
+	static void ResampleChannel(const std::vector<Key>& Keys, Value Key::*Member, const Bone& Track, size_t Count, float SamplesPerTick,
+								Sampler Sample, std::vector<Value>& Result);
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include "glm/gtx/quaternion.hpp"
+#include "Orientation.h"
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+//Keys resampled at a fixed rate, so a key's index is its time and no timestamps are stored.
+//Sample i of every channel sits at tick i / m_SampleRate, a channel that never changes keeps one sample.
+struct UniformTrack
+{
+    float m_SampleRate{ 1.0f };                 //samples per tick
+    std::vector<glm::vec3> m_Positions;
+    std::vector<glm::quat> m_Rotations;
+    std::vector<glm::vec3> m_Scales;
+
+    //nlerp only for tracks the compiler flagged, see Bone::m_Nlerp
+    void Sample(float time, glm::vec3& position, glm::quat& rotation, glm::vec3& scale, bool nlerp = false) const
+    {
+        float frame{ (std::max)(time * m_SampleRate, 0.0f) };
+        size_t index{ static_cast<size_t>(frame) };
+        float factor{ frame - static_cast<float>(index) };
+
+        if (!m_Positions.empty())
+        {
+            position = glm::mix(m_Positions[Clamp(index, m_Positions)], m_Positions[Clamp(index + 1, m_Positions)], factor);
+        }
+
+        if (!m_Rotations.empty())
+        {
+            const glm::quat& from{ m_Rotations[Clamp(index, m_Rotations)] };
+            const glm::quat& to{ m_Rotations[Clamp(index + 1, m_Rotations)] };
+
+            rotation = Orientation::Interpolate(from, to, factor, nlerp);
+        }
+
+        if (!m_Scales.empty())
+        {
+            scale = glm::mix(m_Scales[Clamp(index, m_Scales)], m_Scales[Clamp(index + 1, m_Scales)], factor);
+        }
+    }
+
+    //past the last sample both ends clamp to it, so the factor no longer matters
+    template <typename T>
+    static size_t Clamp(size_t index, const std::vector<T>& samples)
+    {
+        return (std::min)(index, samples.size() - 1);
+    }
+};